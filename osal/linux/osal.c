@@ -18,12 +18,52 @@
  *------------------------------------------------------------------------------
  */
 
+#define _GNU_SOURCE
 #include <time.h>
 #include <sys/time.h>
+#include <sys/mman.h>
 #include <unistd.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <alloca.h>
+#include <sched.h>
+#include <pthread.h>
 #include <osal.h>
 
 #define USECS_PER_SEC     1000000
+#define NSECS_PER_SEC     1000000000
+/** default sleep slack in ns */
+#define OSAL_SLEEPSLACK   50000
+/** huge page size used for arena allocations */
+#define OSAL_HUGEPAGESIZE (2 * 1024 * 1024)
+/** default thread stack size if none is given */
+#define OSAL_STACKSIZE    (128 * 1024)
+/** part of the usable stack that is not prefaulted, used by the prefault itself */
+#define OSAL_STACKMARGIN  (8 * 1024)
+
+/** start parameters handed from osal_thread_create_rt() to the new thread */
+typedef struct
+{
+   void   (*func)(void *);
+   void   *param;
+} osal_threadstartt;
+
+static pthread_mutex_t osal_memlock_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int osal_memlocked = FALSE;
+/** part of a sleep until a deadline in ns that is spent spinning */
+static int64 osal_sleepslack = OSAL_SLEEPSLACK;
+
+/** Set the last part of osal_sleep_until_ns() that is spent spinning
+ * instead of sleeping in the kernel. The kernel wakeup is late by some tens
+ * of us, spinning the slack gives a precise wakeup at the cost of CPU time.
+ * Only the cyclic executors sleep until a deadline, osal_usleep() always
+ * sleeps in the kernel. 0 disables spinning. */
+void osal_set_sleep_slack (uint32 slack_ns)
+{
+   osal_sleepslack = slack_ns;
+}
 
 int osal_usleep (uint32 usec)
 {
@@ -88,3 +128,249 @@ boolean osal_timer_is_expired (const osal_timert * self)
 
    return is_not_yet_expired == FALSE;
 }
+
+int64 osal_current_time_ns (void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ((int64)ts.tv_sec * NSECS_PER_SEC) + ts.tv_nsec;
+}
+
+int osal_sleep_until_ns (int64 abstime)
+{
+   struct timespec ts;
+   int64 sleeptime;
+   int ret = 0;
+
+   /* sleep in the kernel up to the slack */
+   sleeptime = abstime - osal_sleepslack;
+   if (sleeptime > osal_current_time_ns())
+   {
+      ts.tv_sec = sleeptime / NSECS_PER_SEC;
+      ts.tv_nsec = sleeptime % NSECS_PER_SEC;
+      do
+      {
+         ret = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+      }
+      while (ret == EINTR);
+   }
+   /* spin the rest */
+   while (osal_current_time_ns() < abstime);
+   return ret;
+}
+
+int osal_thread_create(void *thandle, int stacksize, void *func, void *param)
+{
+   int                  ret;
+   pthread_attr_t       attr;
+   pthread_t            *threadp;
+
+   threadp = thandle;
+   pthread_attr_init(&attr);
+   pthread_attr_setstacksize(&attr, stacksize > 0 ? stacksize : OSAL_STACKSIZE);
+   ret = pthread_create(threadp, &attr, func, param);
+   pthread_attr_destroy(&attr);
+   if (ret)
+   {
+      return 0;
+   }
+   return 1;
+}
+
+/* Lock all current and future pages of the process in memory, done once. */
+static int osal_memlock (void)
+{
+   int ret = TRUE;
+
+   pthread_mutex_lock(&osal_memlock_mutex);
+   if (!osal_memlocked)
+   {
+      if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0)
+      {
+         osal_memlocked = TRUE;
+      }
+      else
+      {
+         /* no CAP_IPC_LOCK and RLIMIT_MEMLOCK too small */
+         ret = FALSE;
+      }
+   }
+   pthread_mutex_unlock(&osal_memlock_mutex);
+   return ret;
+}
+
+/* Touch every page of the stack that the thread can use so it is
+ * mapped (and locked) before the first cycle runs. The usable stack is
+ * taken from the thread itself, glibc keeps the guard page, the thread
+ * descriptor and the static TLS in the same mapping. */
+static void osal_prefault_stack (void)
+{
+   volatile uint8 *stack;
+   pthread_attr_t attr;
+   void *stackaddr;
+   size_t stacksize, guardsize;
+   ptrdiff_t size;
+   int pagesize, i;
+
+   if (pthread_getattr_np(pthread_self(), &attr))
+   {
+      return;
+   }
+   stackaddr = NULL;
+   guardsize = 0;
+   pthread_attr_getstack(&attr, &stackaddr, &stacksize);
+   pthread_attr_getguardsize(&attr, &guardsize);
+   pthread_attr_destroy(&attr);
+   /* from the current frame down to the guard, the stack grows down */
+   size = (uint8 *)&attr - (uint8 *)stackaddr - (ptrdiff_t)guardsize - OSAL_STACKMARGIN;
+   if (!stackaddr || (size <= 0))
+   {
+      return;
+   }
+   pagesize = sysconf(_SC_PAGESIZE);
+   stack = alloca(size);
+   for (i = 0; i < size; i += pagesize)
+   {
+      stack[i] = 0;
+   }
+}
+
+static void *osal_thread_start (void *arg)
+{
+   osal_threadstartt start;
+
+   start = *(osal_threadstartt *)arg;
+   free(arg);
+   osal_prefault_stack();
+   start.func(start.param);
+   return NULL;
+}
+
+int osal_thread_create_rt(void *thandle, int stacksize, void *func, void *param,
+                          int priority, uint32 cpumask)
+{
+   int                  ret, cpu;
+   pthread_attr_t       attr;
+   struct sched_param   schparam;
+   cpu_set_t            cpuset;
+   pthread_t            *threadp;
+   osal_threadstartt    *start;
+
+   if ((priority < sched_get_priority_min(SCHED_FIFO)) ||
+       (priority > sched_get_priority_max(SCHED_FIFO)))
+   {
+      return 0;
+   }
+   /* page faults in the cyclic part are not acceptable */
+   if (!osal_memlock())
+   {
+      return 0;
+   }
+   if (stacksize <= 0)
+   {
+      stacksize = OSAL_STACKSIZE;
+   }
+   start = malloc(sizeof(osal_threadstartt));
+   if (start == NULL)
+   {
+      return 0;
+   }
+   start->func = func;
+   start->param = param;
+
+   threadp = thandle;
+   pthread_attr_init(&attr);
+   pthread_attr_setstacksize(&attr, stacksize);
+   /* do not inherit the policy of the creating thread */
+   pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+   pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+   memset(&schparam, 0, sizeof(schparam));
+   schparam.sched_priority = priority;
+   pthread_attr_setschedparam(&attr, &schparam);
+   if (cpumask)
+   {
+      CPU_ZERO(&cpuset);
+      for (cpu = 0; cpu < 32; cpu++)
+      {
+         if (cpumask & (1UL << cpu))
+         {
+            CPU_SET(cpu, &cpuset);
+         }
+      }
+      pthread_attr_setaffinity_np(&attr, sizeof(cpuset), &cpuset);
+   }
+   /* fails with EPERM without CAP_SYS_NICE or a sufficient RLIMIT_RTPRIO */
+   ret = pthread_create(threadp, &attr, osal_thread_start, start);
+   pthread_attr_destroy(&attr);
+   if (ret)
+   {
+      free(start);
+      return 0;
+   }
+   return 1;
+}
+
+/* Write to every page so it is mapped now and not in the cyclic path. */
+static void osal_arena_prefault (void *arena, size_t size)
+{
+   volatile uint8 *p;
+   size_t pagesize, i;
+
+   p = arena;
+   pagesize = sysconf(_SC_PAGESIZE);
+   for (i = 0; i < size; i += pagesize)
+   {
+      p[i] = 0;
+   }
+}
+
+/* huge page allocations are rounded to the huge page size */
+static size_t osal_arena_size (size_t size, int flags)
+{
+   if (flags & OSAL_ARENA_HUGEPAGE)
+   {
+      size = (size + OSAL_HUGEPAGESIZE - 1) & ~(size_t)(OSAL_HUGEPAGESIZE - 1);
+   }
+   return size;
+}
+
+/** Allocate zeroed memory arena. If huge pages are requested but not
+ * available the arena falls back to normal pages of just the size and
+ * OSAL_ARENA_HUGEPAGE is cleared in flags. Returns NULL on failure. */
+void *osal_arena_alloc (size_t size, int *flags)
+{
+   void *arena = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+   if (*flags & OSAL_ARENA_HUGEPAGE)
+   {
+      arena = mmap(NULL, osal_arena_size(size, *flags), PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+   }
+#endif
+   if (arena == MAP_FAILED)
+   {
+      *flags &= ~OSAL_ARENA_HUGEPAGE;
+      arena = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+   }
+   if (arena == MAP_FAILED)
+   {
+      return NULL;
+   }
+   if (*flags & OSAL_ARENA_PREFAULT)
+   {
+      osal_arena_prefault(arena, size);
+   }
+   return arena;
+}
+
+/** Free memory arena, size and flags as returned by osal_arena_alloc(). */
+void osal_arena_free (void *arena, size_t size, int flags)
+{
+   if (arena)
+   {
+      munmap(arena, osal_arena_size(size, flags));
+   }
+}
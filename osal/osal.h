@@ -22,6 +22,7 @@
 #define _osal_
 
 #include <stdint.h>
+#include <stddef.h>
 
 /* General types */
 typedef uint8_t             boolean;
@@ -65,5 +66,65 @@ void osal_timer_start (osal_timert * self, uint32 timeout_us);
 boolean osal_timer_is_expired (osal_timert * self);
 int osal_usleep (uint32 usec);
 ec_timet osal_current_time (void);
+int64 osal_current_time_ns (void);
+int osal_sleep_until_ns (int64 abstime);
+void osal_set_sleep_slack (uint32 slack_ns);
+int osal_thread_create (void *thandle, int stacksize, void *func, void *param);
+int osal_thread_create_rt (void *thandle, int stacksize, void *func, void *param,
+                           int priority, uint32 cpumask);
+
+/** arena flag, try to back the arena with huge pages */
+#define OSAL_ARENA_HUGEPAGE 0x01
+/** arena flag, touch all pages at allocation so no page faults follow */
+#define OSAL_ARENA_PREFAULT 0x02
+
+void *osal_arena_alloc (size_t size, int *flags);
+void osal_arena_free (void *arena, size_t size, int flags);
+
+/** size of a cache line, producer and consumer indexes of a ring are
+ * kept on separate lines */
+#define OSAL_CACHELINE      64
+
+/** Bounded lock-free ring of fixed size elements. The buffer is supplied
+ * by the caller, the number of slots must be a power of two. Use the
+ * osal_spsc_ functions for one producer and one consumer thread, use the
+ * osal_mpsc_ functions for any number of producers and one consumer.
+ * A ring must only be used with the family it was initialised with. */
+typedef struct osal_ring
+{
+   uint8           *buf;
+   uint32          mask;
+   uint32          elemsize;
+   uint32          stride;
+   uint8           pad0[OSAL_CACHELINE - sizeof(uint8 *) - (3 * sizeof(uint32))];
+   /** producer position */
+   volatile uint32 head;
+   uint8           pad1[OSAL_CACHELINE - sizeof(uint32)];
+   /** consumer position */
+   volatile uint32 tail;
+   uint8           pad2[OSAL_CACHELINE - sizeof(uint32)];
+} osal_ringt;
+
+/** size of a slot in a MPSC ring, element plus sequence number */
+#define OSAL_MPSC_STRIDE(elemsize) \
+   ((sizeof(uint32) + (elemsize) + sizeof(uint32) - 1) & ~(sizeof(uint32) - 1))
+/** buffer size needed for a SPSC ring */
+#define OSAL_SPSC_BUFSIZE(slots, elemsize)  ((slots) * (elemsize))
+/** buffer size needed for a MPSC ring */
+#define OSAL_MPSC_BUFSIZE(slots, elemsize)  ((slots) * OSAL_MPSC_STRIDE(elemsize))
+
+int osal_spsc_init (osal_ringt *ring, void *buf, uint32 slots, uint32 elemsize);
+boolean osal_spsc_push (osal_ringt *ring, const void *elem);
+boolean osal_spsc_pop (osal_ringt *ring, void *elem);
+int osal_mpsc_init (osal_ringt *ring, void *buf, uint32 slots, uint32 elemsize);
+boolean osal_mpsc_push (osal_ringt *ring, const void *elem);
+boolean osal_mpsc_pop (osal_ringt *ring, void *elem);
+uint32 osal_ring_count (osal_ringt *ring);
+
+/* atomics for publishing data between threads */
+uint32 osal_atomic_load (volatile uint32 *p);
+void osal_atomic_store (volatile uint32 *p, uint32 v);
+uint32 osal_atomic_exchange (volatile uint32 *p, uint32 v);
+void osal_atomic_fence (void);
 
 #endif
@@ -0,0 +1,213 @@
+/******************************************************************************
+ *                *          ***                    ***
+ *              ***          ***                    ***
+ * ***  ****  **********     ***        *****       ***  ****          *****
+ * *********  **********     ***      *********     ************     *********
+ * ****         ***          ***              ***   ***       ****   ***
+ * ***          ***  ******  ***      ***********   ***        ****   *****
+ * ***          ***  ******  ***    *************   ***        ****      *****
+ * ***          ****         ****   ***       ***   ***       ****          ***
+ * ***           *******      ***** **************  *************    *********
+ * ***             *****        ***   *******   **  **  ******         *****
+ *                           t h e  r e a l t i m e  t a r g e t  e x p e r t s
+ *
+ * http://www.rt-labs.com
+ * Copyright (C) 2009. rt-labs AB, Sweden. All rights reserved.
+ *------------------------------------------------------------------------------
+ * $Id$
+ *------------------------------------------------------------------------------
+ */
+
+/* Bounded lock-free rings for handing data between the cyclic thread and
+ * non RT threads. The SPSC ring is wait-free on both sides. The MPSC ring
+ * uses a sequence number per slot, producers claim a slot with a CAS on
+ * the head, the single consumer is wait-free. The plain atomics at the
+ * end are for other lock-free publish schemes in the stack. */
+
+#include <string.h>
+#include <osal.h>
+
+#if defined(_MSC_VER)
+#include <windows.h>
+/* on x86 volatile accesses are ordered, only stop compiler reordering */
+#define RING_LOAD_ACQ(p)       (_ReadWriteBarrier(), *(p))
+#define RING_STORE_REL(p, v)   do { _ReadWriteBarrier(); *(p) = (v); } while (0)
+#define RING_LOAD(p)           (*(p))
+#define RING_CAS(p, o, n)      \
+   (InterlockedCompareExchange((volatile LONG *)(p), (LONG)(n), (LONG)(o)) == (LONG)(o))
+#define RING_XCHG(p, v)        \
+   ((uint32)InterlockedExchange((volatile LONG *)(p), (LONG)(v)))
+#define RING_FENCE()           MemoryBarrier()
+#else
+#define RING_LOAD_ACQ(p)       __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define RING_STORE_REL(p, v)   __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define RING_LOAD(p)           __atomic_load_n((p), __ATOMIC_RELAXED)
+#define RING_CAS(p, o, n)      \
+   __atomic_compare_exchange_n((p), &(o), (n), FALSE, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)
+#define RING_XCHG(p, v)        __atomic_exchange_n((p), (v), __ATOMIC_ACQ_REL)
+#define RING_FENCE()           __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+/* sequence number in front of each MPSC slot */
+#define RING_SEQ(ring, pos)    \
+   ((volatile uint32 *)((ring)->buf + (((pos) & (ring)->mask) * (ring)->stride)))
+#define RING_MPSC_ELEM(ring, pos)  \
+   ((ring)->buf + (((pos) & (ring)->mask) * (ring)->stride) + sizeof(uint32))
+
+static int osal_ring_setup (osal_ringt *ring, void *buf, uint32 slots,
+                            uint32 elemsize, uint32 stride)
+{
+   if ((slots < 2) || (slots & (slots - 1)) || (elemsize == 0) || (buf == NULL))
+   {
+      return 0;
+   }
+   memset(ring, 0, sizeof(osal_ringt));
+   ring->buf = buf;
+   ring->mask = slots - 1;
+   ring->elemsize = elemsize;
+   ring->stride = stride;
+   return 1;
+}
+
+/** Initialise single producer, single consumer ring.
+ * buf must hold OSAL_SPSC_BUFSIZE(slots, elemsize) bytes.
+ * Returns 1 on success, 0 if slots is not a power of two. */
+int osal_spsc_init (osal_ringt *ring, void *buf, uint32 slots, uint32 elemsize)
+{
+   return osal_ring_setup(ring, buf, slots, elemsize, elemsize);
+}
+
+/** Copy element into SPSC ring, producer side. Returns FALSE if full. */
+boolean osal_spsc_push (osal_ringt *ring, const void *elem)
+{
+   uint32 head, tail;
+
+   head = RING_LOAD(&ring->head);
+   tail = RING_LOAD_ACQ(&ring->tail);
+   if ((head - tail) > ring->mask)
+   {
+      return FALSE;
+   }
+   memcpy(ring->buf + ((head & ring->mask) * ring->stride), elem, ring->elemsize);
+   RING_STORE_REL(&ring->head, head + 1);
+   return TRUE;
+}
+
+/** Copy element out of SPSC ring, consumer side. Returns FALSE if empty. */
+boolean osal_spsc_pop (osal_ringt *ring, void *elem)
+{
+   uint32 head, tail;
+
+   tail = RING_LOAD(&ring->tail);
+   head = RING_LOAD_ACQ(&ring->head);
+   if (head == tail)
+   {
+      return FALSE;
+   }
+   memcpy(elem, ring->buf + ((tail & ring->mask) * ring->stride), ring->elemsize);
+   RING_STORE_REL(&ring->tail, tail + 1);
+   return TRUE;
+}
+
+/** Initialise multi producer, single consumer ring.
+ * buf must hold OSAL_MPSC_BUFSIZE(slots, elemsize) bytes.
+ * Returns 1 on success, 0 if slots is not a power of two. */
+int osal_mpsc_init (osal_ringt *ring, void *buf, uint32 slots, uint32 elemsize)
+{
+   uint32 i;
+
+   if (!osal_ring_setup(ring, buf, slots, elemsize, OSAL_MPSC_STRIDE(elemsize)))
+   {
+      return 0;
+   }
+   for (i = 0; i < slots; i++)
+   {
+      *RING_SEQ(ring, i) = i;
+   }
+   return 1;
+}
+
+/** Copy element into MPSC ring, safe from any number of producers.
+ * Returns FALSE if full. */
+boolean osal_mpsc_push (osal_ringt *ring, const void *elem)
+{
+   uint32 pos, seq;
+   int32 dif;
+
+   pos = RING_LOAD(&ring->head);
+   for (;;)
+   {
+      seq = RING_LOAD_ACQ(RING_SEQ(ring, pos));
+      dif = (int32)(seq - pos);
+      if (dif == 0)
+      {
+         /* slot free, try to claim it */
+         if (RING_CAS(&ring->head, pos, pos + 1))
+         {
+            break;
+         }
+         pos = RING_LOAD(&ring->head);
+      }
+      else if (dif < 0)
+      {
+         /* slot still holds an element one lap behind */
+         return FALSE;
+      }
+      else
+      {
+         /* another producer was faster */
+         pos = RING_LOAD(&ring->head);
+      }
+   }
+   memcpy(RING_MPSC_ELEM(ring, pos), elem, ring->elemsize);
+   RING_STORE_REL(RING_SEQ(ring, pos), pos + 1);
+   return TRUE;
+}
+
+/** Copy element out of MPSC ring, consumer side. Returns FALSE if empty
+ * or if the oldest slot is claimed but not yet filled. */
+boolean osal_mpsc_pop (osal_ringt *ring, void *elem)
+{
+   uint32 pos, seq;
+
+   pos = RING_LOAD(&ring->tail);
+   seq = RING_LOAD_ACQ(RING_SEQ(ring, pos));
+   if ((int32)(seq - (pos + 1)) < 0)
+   {
+      return FALSE;
+   }
+   memcpy(elem, RING_MPSC_ELEM(ring, pos), ring->elemsize);
+   RING_STORE_REL(RING_SEQ(ring, pos), pos + ring->mask + 1);
+   RING_STORE_REL(&ring->tail, pos + 1);
+   return TRUE;
+}
+
+/** Number of elements in ring, a snapshot when used concurrently. */
+uint32 osal_ring_count (osal_ringt *ring)
+{
+   return RING_LOAD_ACQ(&ring->head) - RING_LOAD_ACQ(&ring->tail);
+}
+
+/** Load with acquire semantics. */
+uint32 osal_atomic_load (volatile uint32 *p)
+{
+   return RING_LOAD_ACQ(p);
+}
+
+/** Store with release semantics. */
+void osal_atomic_store (volatile uint32 *p, uint32 v)
+{
+   RING_STORE_REL(p, v);
+}
+
+/** Exchange, returns the previous value. Full acquire / release. */
+uint32 osal_atomic_exchange (volatile uint32 *p, uint32 v)
+{
+   return RING_XCHG(p, v);
+}
+
+/** Full memory barrier. */
+void osal_atomic_fence (void)
+{
+   RING_FENCE();
+}
@@ -21,10 +21,49 @@
 
 #include <time.h>
 #include <sys/time.h>
+#include <sys/mman.h>
+#include <sys/neutrino.h>
 #include <unistd.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <alloca.h>
+#include <sched.h>
+#include <pthread.h>
 #include <osal.h>
 
 #define USECS_PER_SEC     1000000
+#define NSECS_PER_SEC     1000000000
+/** default sleep slack in ns */
+#define OSAL_SLEEPSLACK   50000
+/** default thread stack size if none is given */
+#define OSAL_STACKSIZE    (128 * 1024)
+/** part of the stack that is not prefaulted, used by the thread start itself */
+#define OSAL_STACKMARGIN  (8 * 1024)
+
+/** start parameters handed from osal_thread_create_rt() to the new thread */
+typedef struct
+{
+   void   (*func)(void *);
+   void   *param;
+   int    prefault;
+   uint32 cpumask;
+} osal_threadstartt;
+
+static pthread_mutex_t osal_memlock_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int osal_memlocked = FALSE;
+/** part of a sleep until a deadline in ns that is spent spinning */
+static int64 osal_sleepslack = OSAL_SLEEPSLACK;
+
+/** Set the last part of osal_sleep_until_ns() that is spent spinning
+ * instead of sleeping in the kernel. The kernel wakeup is late by some tens
+ * of us, spinning the slack gives a precise wakeup at the cost of CPU time.
+ * Only the cyclic executors sleep until a deadline, osal_usleep() always
+ * sleeps in the kernel. 0 disables spinning. */
+void osal_set_sleep_slack (uint32 slack_ns)
+{
+   osal_sleepslack = slack_ns;
+}
 
 int osal_usleep (uint32 usec)
 {
@@ -89,3 +128,197 @@ boolean osal_timer_is_expired (osal_timert * self)
 
    return is_not_yet_expired == FALSE;
 }
+
+int64 osal_current_time_ns (void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ((int64)ts.tv_sec * NSECS_PER_SEC) + ts.tv_nsec;
+}
+
+int osal_sleep_until_ns (int64 abstime)
+{
+   struct timespec ts;
+   int64 sleeptime;
+   int ret = 0;
+
+   /* sleep in the kernel up to the slack */
+   sleeptime = abstime - osal_sleepslack;
+   if (sleeptime > osal_current_time_ns())
+   {
+      ts.tv_sec = sleeptime / NSECS_PER_SEC;
+      ts.tv_nsec = sleeptime % NSECS_PER_SEC;
+      do
+      {
+         ret = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+      }
+      while (ret == EINTR);
+   }
+   /* spin the rest */
+   while (osal_current_time_ns() < abstime);
+   return ret;
+}
+
+int osal_thread_create(void *thandle, int stacksize, void *func, void *param)
+{
+   int                  ret;
+   pthread_attr_t       attr;
+   pthread_t            *threadp;
+
+   threadp = thandle;
+   pthread_attr_init(&attr);
+   pthread_attr_setstacksize(&attr, stacksize > 0 ? stacksize : OSAL_STACKSIZE);
+   ret = pthread_create(threadp, &attr, func, param);
+   pthread_attr_destroy(&attr);
+   if (ret)
+   {
+      return 0;
+   }
+   return 1;
+}
+
+/* Lock all current and future pages of the process in memory, done once. */
+static int osal_memlock (void)
+{
+   int ret = TRUE;
+
+   pthread_mutex_lock(&osal_memlock_mutex);
+   if (!osal_memlocked)
+   {
+      if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0)
+      {
+         osal_memlocked = TRUE;
+      }
+      else
+      {
+         ret = FALSE;
+      }
+   }
+   pthread_mutex_unlock(&osal_memlock_mutex);
+   return ret;
+}
+
+/* Touch every page of the stack that the thread can use so it is
+ * mapped (and locked) before the first cycle runs. */
+static void osal_prefault_stack (int size)
+{
+   volatile uint8 *stack;
+   int pagesize, i;
+
+   pagesize = sysconf(_SC_PAGESIZE);
+   stack = alloca(size);
+   for (i = 0; i < size; i += pagesize)
+   {
+      stack[i] = 0;
+   }
+}
+
+static void *osal_thread_start (void *arg)
+{
+   osal_threadstartt start;
+
+   start = *(osal_threadstartt *)arg;
+   free(arg);
+   /* QNX has no affinity attribute, the runmask is set by the thread itself */
+   if (start.cpumask)
+   {
+      ThreadCtl(_NTO_TCTL_RUNMASK, (void *)start.cpumask);
+   }
+   osal_prefault_stack(start.prefault);
+   start.func(start.param);
+   return NULL;
+}
+
+int osal_thread_create_rt(void *thandle, int stacksize, void *func, void *param,
+                          int priority, uint32 cpumask)
+{
+   int                  ret;
+   pthread_attr_t       attr;
+   struct sched_param   schparam;
+   pthread_t            *threadp;
+   osal_threadstartt    *start;
+
+   if ((priority < sched_get_priority_min(SCHED_FIFO)) ||
+       (priority > sched_get_priority_max(SCHED_FIFO)))
+   {
+      return 0;
+   }
+   if (!osal_memlock())
+   {
+      return 0;
+   }
+   if (stacksize <= OSAL_STACKMARGIN)
+   {
+      stacksize = OSAL_STACKSIZE;
+   }
+   start = malloc(sizeof(osal_threadstartt));
+   if (start == NULL)
+   {
+      return 0;
+   }
+   start->func = func;
+   start->param = param;
+   start->prefault = stacksize - OSAL_STACKMARGIN;
+   start->cpumask = cpumask;
+
+   threadp = thandle;
+   pthread_attr_init(&attr);
+   pthread_attr_setstacksize(&attr, stacksize);
+   pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+   pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+   memset(&schparam, 0, sizeof(schparam));
+   schparam.sched_priority = priority;
+   pthread_attr_setschedparam(&attr, &schparam);
+   ret = pthread_create(threadp, &attr, osal_thread_start, start);
+   pthread_attr_destroy(&attr);
+   if (ret)
+   {
+      free(start);
+      return 0;
+   }
+   return 1;
+}
+
+/* Write to every page so it is mapped now and not in the cyclic path. */
+static void osal_arena_prefault (void *arena, size_t size)
+{
+   volatile uint8 *p;
+   size_t pagesize, i;
+
+   p = arena;
+   pagesize = sysconf(_SC_PAGESIZE);
+   for (i = 0; i < size; i += pagesize)
+   {
+      p[i] = 0;
+   }
+}
+
+/** Allocate zeroed memory arena. Huge pages are not used on QNX,
+ * OSAL_ARENA_HUGEPAGE is cleared in flags. Returns NULL on failure. */
+void *osal_arena_alloc (size_t size, int *flags)
+{
+   void *arena;
+
+   *flags &= ~OSAL_ARENA_HUGEPAGE;
+   arena = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANON, NOFD, 0);
+   if (arena == MAP_FAILED)
+   {
+      return NULL;
+   }
+   if (*flags & OSAL_ARENA_PREFAULT)
+   {
+      osal_arena_prefault(arena, size);
+   }
+   return arena;
+}
+
+/** Free memory arena, size and flags as returned by osal_arena_alloc(). */
+void osal_arena_free (void *arena, size_t size, int flags)
+{
+   if (arena)
+   {
+      munmap(arena, size);
+   }
+}
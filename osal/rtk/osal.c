@@ -23,6 +23,7 @@
 #include <time.h>
 #include <sys/time.h>
 #include <config.h>
+#include <stdlib.h>
 
 #define  timercmp(a, b, CMP)                                \
   (((a)->tv_sec == (b)->tv_sec) ?                           \
@@ -129,3 +130,65 @@ boolean osal_timer_is_expired (osal_timert * self)
    return is_not_yet_expired == false;
 }
 
+
+int64 osal_current_time_ns (void)
+{
+   return (int64)tick_get() * USECS_PER_TICK * 1000;
+}
+
+/** Sleep slack, rt-kernel sleeps in ticks and does not spin. */
+void osal_set_sleep_slack (uint32 slack_ns)
+{
+}
+
+int osal_sleep_until_ns (int64 abstime)
+{
+   int64 left;
+
+   left = abstime - osal_current_time_ns();
+   if (left > 0)
+   {
+      udelay((uint32)(left / 1000));
+   }
+   return 0;
+}
+
+int osal_thread_create(void *thandle, int stacksize, void *func, void *param)
+{
+   task_t **taskp = thandle;
+
+   *taskp = task_spawn ("worker", func, 6, stacksize, param);
+   if (*taskp == NULL)
+   {
+      return 0;
+   }
+   return 1;
+}
+
+int osal_thread_create_rt(void *thandle, int stacksize, void *func, void *param,
+                          int priority, uint32 cpumask)
+{
+   task_t **taskp = thandle;
+
+   /* rt-kernel is single core and does not page, only the priority applies */
+   *taskp = task_spawn ("worker_rt", func, priority, stacksize, param);
+   if (*taskp == NULL)
+   {
+      return 0;
+   }
+   return 1;
+}
+
+/** Allocate zeroed memory arena. rt-kernel has no paging,
+ * OSAL_ARENA_HUGEPAGE is cleared in flags. Returns NULL on failure. */
+void *osal_arena_alloc (size_t size, int *flags)
+{
+   *flags &= ~OSAL_ARENA_HUGEPAGE;
+   return calloc(1, size);
+}
+
+/** Free memory arena, size and flags as returned by osal_arena_alloc(). */
+void osal_arena_free (void *arena, size_t size, int flags)
+{
+   free(arena);
+}
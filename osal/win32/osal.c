@@ -26,6 +26,11 @@ static int64_t sysfrequency;
 static double qpc2usec;
 
 #define USECS_PER_SEC     1000000
+/** default sleep slack in ns */
+#define OSAL_SLEEPSLACK   50000
+
+/** part of a sleep until a deadline in ns that is spent spinning */
+static int64 osal_sleepslack = OSAL_SLEEPSLACK;
   
 int osal_gettimeofday (struct timeval *tv, struct timezone *tz)
 {
@@ -88,3 +93,119 @@ int osal_usleep(uint32 usec)
    SleepEx(usec / 1000, FALSE);
    return 1;
 }
+
+int64 osal_current_time_ns (void)
+{
+   int64_t wintime;
+   if(!sysfrequency)
+   {
+      QueryPerformanceFrequency((LARGE_INTEGER *)&sysfrequency);
+      qpc2usec = 1000000.0 / sysfrequency;
+   }
+   QueryPerformanceCounter((LARGE_INTEGER *)&wintime);
+   return (int64)((double)wintime * qpc2usec * 1000.0);
+}
+
+/** Set the last part of osal_sleep_until_ns() that is spent spinning
+ * instead of sleeping. Windows sleeps in whole ms, below that the thread
+ * yields until the slack. osal_usleep() does not spin. */
+void osal_set_sleep_slack (uint32 slack_ns)
+{
+   osal_sleepslack = slack_ns;
+}
+
+int osal_sleep_until_ns (int64 abstime)
+{
+   int64 left;
+
+   /* sleep in whole ms while far away, yield up to the slack */
+   while ((left = abstime - osal_current_time_ns() - osal_sleepslack) > 0)
+   {
+      SleepEx(left >= 2000000 ? (DWORD)(left / 1000000) - 1 : 0, FALSE);
+   }
+   /* spin the rest */
+   while (osal_current_time_ns() < abstime);
+   return 0;
+}
+
+int osal_thread_create(void *thandle, int stacksize, void *func, void *param)
+{
+   HANDLE *threadp = thandle;
+
+   *threadp = CreateThread(NULL, stacksize, func, param, 0, NULL);
+   if (*threadp == NULL)
+   {
+      return 0;
+   }
+   return 1;
+}
+
+int osal_thread_create_rt(void *thandle, int stacksize, void *func, void *param,
+                          int priority, uint32 cpumask)
+{
+   HANDLE *threadp = thandle;
+
+   /* windows has no fixed priority scheduler, use the highest class
+    * and pin to the requested CPUs. Memory is not locked. */
+   *threadp = CreateThread(NULL, stacksize, func, param, CREATE_SUSPENDED, NULL);
+   if (*threadp == NULL)
+   {
+      return 0;
+   }
+   if (!SetThreadPriority(*threadp, THREAD_PRIORITY_TIME_CRITICAL) ||
+       (cpumask && !SetThreadAffinityMask(*threadp, cpumask)))
+   {
+      TerminateThread(*threadp, 0);
+      CloseHandle(*threadp);
+      *threadp = NULL;
+      return 0;
+   }
+   ResumeThread(*threadp);
+   return 1;
+}
+
+/** Allocate zeroed memory arena. Large pages need the "lock pages in
+ * memory" privilege, without it normal pages are used and
+ * OSAL_ARENA_HUGEPAGE is cleared in flags. Returns NULL on failure. */
+void *osal_arena_alloc (size_t size, int *flags)
+{
+   void *arena = NULL;
+   SIZE_T large;
+   SYSTEM_INFO info;
+   volatile uint8 *p;
+   size_t i;
+
+   if (*flags & OSAL_ARENA_HUGEPAGE)
+   {
+      large = GetLargePageMinimum();
+      if (large)
+      {
+         arena = VirtualAlloc(NULL, (size + large - 1) & ~(large - 1),
+            MEM_COMMIT | MEM_RESERVE | MEM_LARGE_PAGES, PAGE_READWRITE);
+      }
+   }
+   if (arena == NULL)
+   {
+      *flags &= ~OSAL_ARENA_HUGEPAGE;
+      arena = VirtualAlloc(NULL, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+   }
+   if (arena && (*flags & OSAL_ARENA_PREFAULT))
+   {
+      GetSystemInfo(&info);
+      p = arena;
+      for (i = 0; i < size; i += info.dwPageSize)
+      {
+         p[i] = 0;
+      }
+   }
+   return arena;
+}
+
+/** Free memory arena, size and flags as returned by osal_arena_alloc(). */
+void osal_arena_free (void *arena, size_t size, int flags)
+{
+   if (arena)
+   {
+      VirtualFree(arena, 0, MEM_RELEASE);
+   }
+}
@@ -515,7 +515,8 @@ static int ecx_recvpkt(ecx_portt *port, int stacknumber)
  * index, store in buffer, set completed flag in buffer status and exit.
  * 
  * @param[in] port        = port context struct
- * @param[in] idx         = requested index of frame
+ * @param[in] idx         = requested index of frame, EC_MAXBUF only stores
+ * a received frame in the buffer array
  * @param[in] stacknumber = 0=primary 1=secondary stack
  * @return Workcounter if a frame is found with corresponding index, otherwise
  * EC_NOFRAME or EC_OTHERFRAME.
@@ -539,7 +540,7 @@ int ecx_inframe(ecx_portt *port, int idx, int stacknumber)
       stack = &(port->redport->stack);
    }
    rval = EC_NOFRAME;
-   rxbuf = &(*stack->rxbuf)[idx];
+   rxbuf = (idx < EC_MAXBUF) ? &(*stack->rxbuf)[idx] : NULL;
    /* check if requested index is already in buffer ? */
    if ((idx < EC_MAXBUF) && ((*stack->rxbufstat)[idx] == EC_BUF_RCVD)) 
    {
@@ -565,7 +566,7 @@ int ecx_inframe(ecx_portt *port, int idx, int stacknumber)
             idxf = ecp->index;
 
             /* found index equals reqested index ? */
-            if (idxf == idx) 
+            if ((idxf == idx) && (idx < EC_MAXBUF))
             {
                /* yes, put it in the buffer array (strip ethernet header) */
                memcpy(rxbuf, &(*stack->tempbuf)[ETH_HEADERSIZE], (*stack->txbuflength)[idx] - ETH_HEADERSIZE);
@@ -719,6 +720,41 @@ int ecx_waitinframe(ecx_portt *port, int idx, int timeout)
    return wkc;
 }
 
+/** Non blocking receive frame function. Reads at most one frame per port
+ * into the buffer array and checks if the requested index is complete.
+ * In contrast to ecx_waitinframe() the buffer is not released when the
+ * frame is not there yet, so it can be polled again later. In redundant
+ * mode the frame is complete when it arrived on both ports, use
+ * ecx_waitinframe() to finish a frame that only arrives on one port.
+ * @param[in] port        = port context struct
+ * @param[in] idx       = requested index of frame
+ * @return Workcounter if the frame is complete, otherwise EC_NOFRAME.
+ */
+int ecx_pollinframe(ecx_portt *port, int idx)
+{
+   int wkc = EC_NOFRAME;
+   osal_timert timer;
+
+   /* an index out of range only moves a received frame into the buffer array */
+   if (port->rxbufstat[idx] != EC_BUF_RCVD)
+   {
+      ecx_inframe(port, EC_MAXBUF, 0);
+   }
+   if ((port->redstate != ECT_RED_NONE) && (port->redport->rxbufstat[idx] != EC_BUF_RCVD))
+   {
+      ecx_inframe(port, EC_MAXBUF, 1);
+   }
+   if ((port->rxbufstat[idx] == EC_BUF_RCVD) &&
+       ((port->redstate == ECT_RED_NONE) || (port->redport->rxbufstat[idx] == EC_BUF_RCVD)))
+   {
+      /* both frames are in, expired timer so the redundancy handling does not wait */
+      osal_timer_start (&timer, 0);
+      wkc = ecx_waitinframe_red(port, idx, &timer);
+   }
+
+   return wkc;
+}
+
 /** Blocking send and recieve frame function. Used for non processdata frames.
  * A datagram is build into a frame and transmitted via this function. It waits
  * for an answer and returns the workcounter. The function retries if time is
@@ -804,6 +840,11 @@ int ec_waitinframe(int idx, int timeout)
    return ecx_waitinframe(&ecx_port, idx, timeout);
 }
 
+int ec_pollinframe(int idx)
+{
+   return ecx_pollinframe(&ecx_port, idx);
+}
+
 int ec_srconfirm(int idx, int timeout)
 {
    return ecx_srconfirm(&ecx_port, idx, timeout);
@@ -138,6 +138,7 @@ int ec_getindex(void);
 int ec_outframe(int idx, int sock);
 int ec_outframe_red(int idx);
 int ec_waitinframe(int idx, int timeout);
+int ec_pollinframe(int idx);
 int ec_srconfirm(int idx,int timeout);
 #endif
 
@@ -149,6 +150,7 @@ int ecx_getindex(ecx_portt *port);
 int ecx_outframe(ecx_portt *port, int idx, int sock);
 int ecx_outframe_red(ecx_portt *port, int idx);
 int ecx_waitinframe(ecx_portt *port, int idx, int timeout);
+int ecx_pollinframe(ecx_portt *port, int idx);
 int ecx_srconfirm(ecx_portt *port, int idx,int timeout);
 
 #ifdef __cplusplus
@@ -699,7 +699,8 @@ int ecx_TxPDO(ecx_contextt *context, uint16 slave, uint16 TxPDOnumber , int *psi
    return wkc;
 }
 
-/** Read PDO assign structure
+/** Read PDO assign structure. The entries are added to the PDO entry
+ * table while the slave is recorded, see ecx_pdo_begin().
  * @param[in]  context        = context struct
  * @param[in]  Slave         = Slave number
  * @param[in]  PDOassign     = PDO assign object
@@ -746,6 +747,9 @@ int ecx_readPDOassign(ecx_contextt *context, uint16 Slave, uint16 PDOassign)
                /* extract bitlength of SDO */
                if (LO_BYTE(rdat2) < 0xff)
                {
+                  ecx_pdo_add(context, Slave, (uint8)(PDOassign - ECT_SDO_PDOASSIGN),
+                              (uint16)HI_WORD(rdat2), (uint8)HI_BYTE(rdat2), LO_BYTE(rdat2),
+                              bsize, 0, 0);
                   bsize += LO_BYTE(rdat2);
                }
                else
@@ -763,7 +767,8 @@ int ecx_readPDOassign(ecx_contextt *context, uint16 Slave, uint16 PDOassign)
    return bsize;
 }
 
-/** Read PDO assign structure in Complete Access mode
+/** Read PDO assign structure in Complete Access mode. The entries are added
+ * to the PDO entry table while the slave is recorded, see ecx_pdo_begin().
  * @param[in]  context        = context struct
  * @param[in]  Slave         = Slave number
  * @param[in]  PDOassign     = PDO assign object
@@ -773,6 +778,7 @@ int ecx_readPDOassignCA(ecx_contextt *context, uint16 Slave, uint16 PDOassign)
 {
    uint16 idxloop, nidx, subidxloop, idx, subidx;
    int wkc, bsize = 0, rdl;
+   uint32 entry;
 
    /* find maximum size of PDOassign buffer */
    rdl = sizeof(ec_PDOassignt); 
@@ -798,7 +804,10 @@ int ecx_readPDOassignCA(ecx_contextt *context, uint16 Slave, uint16 PDOassign)
             /* extract all bitlengths of SDO's */
             for (subidxloop = 1; subidxloop <= subidx; subidxloop++)
             {
-               bsize += LO_BYTE(etohl(context->PDOdesc->PDO[subidxloop -1]));
+               entry = etohl(context->PDOdesc->PDO[subidxloop -1]);
+               ecx_pdo_add(context, Slave, (uint8)(PDOassign - ECT_SDO_PDOASSIGN),
+                           (uint16)HI_WORD(entry), (uint8)HI_BYTE(entry), LO_BYTE(entry), bsize, 0, 0);
+               bsize += LO_BYTE(entry);
             }
          }
       }
@@ -133,7 +133,8 @@ int ec_findconfig( uint32 man, uint32 id)
  *
  * @param[in]  context        = context struct
  * @param[in] usetable     = TRUE when using configtable to init slaves, FALSE otherwise
- * @return Workcounter of slave discover datagram = number of slaves found
+ * @return Workcounter of slave discover datagram = number of slaves found,
+ * EC_SLAVECOUNTEXCEEDED if the slavelist of the context is too small
  */
 int ecx_config_init(ecx_contextt *context, uint8 usetable)
 {
@@ -152,6 +153,7 @@ int ecx_config_init(ecx_contextt *context, uint8 usetable)
    memset(context->slavelist, 0x00, sizeof(ec_slavet) * context->maxslave);
    memset(&zbuf, 0x00, sizeof(zbuf));
    memset(context->grouplist, 0x00, sizeof(ec_groupt) * context->maxgroup);
+   context->npdoentry = 0;
    /* clear slave eeprom cache */
    ecx_siigetbyte(context, 0, EC_MAXEEPBUF);
    
@@ -172,6 +174,13 @@ int ecx_config_init(ecx_contextt *context, uint8 usetable)
    
    w = 0x0000;
    wkc = ecx_BRD(context->port, 0x0000, ECT_REG_TYPE, sizeof(w), &w, EC_TIMEOUTSAFE);   /* detect number of slaves */
+   if (wkc >= context->maxslave)
+   {
+      /* slavelist[0] is the master, more slaves than entries do not fit */
+      EC_PRINT("Error: too many slaves on network: num_slaves=%d, max_slaves=%d\n",
+         wkc, context->maxslave - 1);
+      return EC_SLAVECOUNTEXCEEDED;
+   }
    if (wkc > 0)
    {
       *(context->slavecount) = wkc;
@@ -522,7 +531,688 @@ int ecx_config_init(ecx_contextt *context, uint8 usetable)
    return wkc;
 }
 
+/** Find the IO mapping of a slave and program its SyncManagers.
+ * The mapping comes from the config table, CoE, SoE or the SII, in that order.
+ *
+ * @param[in]  context        = context struct
+ * @param[in]  slave      = slave number
+ */
+static void ecx_config_find_mappings(ecx_contextt *context, uint16 slave)
+{
+   uint16 configadr;
+   int Isize, Osize, nSM, rval;
+   ec_eepromPDOt eepPDO;
+
+   configadr = context->slavelist[slave].configadr;
+   /* if slave not found in configlist find IO mapping in slave self */
+   if (!context->slavelist[slave].configindex)
+   {
+      Isize = 0;
+      Osize = 0;
+      /* keep the PDO entries of the mapping */
+      ecx_pdo_begin(context, slave);
+      if (context->slavelist[slave].mbx_proto & ECT_MBXPROT_COE) /* has CoE */
+      {
+         rval = 0;
+         if (context->slavelist[slave].CoEdetails & ECT_COEDET_SDOCA) /* has Complete Access */
+            /* read PDO mapping via CoE and use Complete Access */
+         {
+            rval = ecx_readPDOmapCA(context, slave, &Osize, &Isize);
+         }
+         if (!rval) /* CA not available or not succeeded */
+         {
+            /* read PDO mapping via CoE */
+            rval = ecx_readPDOmap(context, slave, &Osize, &Isize);
+         }
+         EC_PRINT("  CoE Osize:%d Isize:%d\n", Osize, Isize);
+      }
+      if ((!Isize && !Osize) && (context->slavelist[slave].mbx_proto & ECT_MBXPROT_SOE)) /* has SoE */
+      {
+         /* read AT / MDT mapping via SoE */
+         rval = ecx_readIDNmap(context, slave, &Osize, &Isize);
+         context->slavelist[slave].SM[2].SMlength = htoes((Osize + 7) / 8);
+         context->slavelist[slave].SM[3].SMlength = htoes((Isize + 7) / 8);
+         EC_PRINT("  SoE Osize:%d Isize:%d\n", Osize, Isize);
+      }
+      if (!Isize && !Osize) /* find PDO mapping by SII */
+      {
+         memset(&eepPDO, 0, sizeof(eepPDO));
+         Isize = (int)ecx_siiPDO(context, slave, &eepPDO, 0);
+         EC_PRINT("  SII Isize:%d\n", Isize);               
+         for( nSM=0 ; nSM < EC_MAXSM ; nSM++ )
+         {   
+            if (eepPDO.SMbitsize[nSM] > 0)
+            {   
+               context->slavelist[slave].SM[nSM].SMlength =  htoes((eepPDO.SMbitsize[nSM] + 7) / 8);
+               context->slavelist[slave].SMtype[nSM] = 4;
+               EC_PRINT("    SM%d length %d\n", nSM, eepPDO.SMbitsize[nSM]);
+            }   
+         }   
+         Osize = (int)ecx_siiPDO(context, slave, &eepPDO, 1);
+         EC_PRINT("  SII Osize:%d\n", Osize);               
+         for( nSM=0 ; nSM < EC_MAXSM ; nSM++ )
+         {   
+            if (eepPDO.SMbitsize[nSM] > 0)
+            {   
+               context->slavelist[slave].SM[nSM].SMlength =  htoes((eepPDO.SMbitsize[nSM] + 7) / 8);
+               context->slavelist[slave].SMtype[nSM] = 3;
+               EC_PRINT("    SM%d length %d\n", nSM, eepPDO.SMbitsize[nSM]);
+            }   
+         }   
+      }
+      ecx_pdo_end(context, slave);
+      context->slavelist[slave].Obits = Osize;
+      context->slavelist[slave].Ibits = Isize;
+      EC_PRINT("     ISIZE:%d %d OSIZE:%d\n", 
+         context->slavelist[slave].Ibits, Isize,context->slavelist[slave].Obits);    
+   }
+
+   EC_PRINT("  SM programming\n");  
+   if (!context->slavelist[slave].mbx_l && context->slavelist[slave].SM[0].StartAddr)
+   {
+      ecx_FPWR(context->port, configadr, ECT_REG_SM0, 
+         sizeof(ec_smt), &(context->slavelist[slave].SM[0]), EC_TIMEOUTRET3);
+      EC_PRINT("    SM0 Type:%d StartAddr:%4.4x Flags:%8.8x\n", 
+          context->slavelist[slave].SMtype[0], 
+          context->slavelist[slave].SM[0].StartAddr, 
+          context->slavelist[slave].SM[0].SMflags);   
+   }
+   if (!context->slavelist[slave].mbx_l && context->slavelist[slave].SM[1].StartAddr)
+   {
+      ecx_FPWR(context->port, configadr, ECT_REG_SM1, 
+         sizeof(ec_smt), &context->slavelist[slave].SM[1], EC_TIMEOUTRET3);
+      EC_PRINT("    SM1 Type:%d StartAddr:%4.4x Flags:%8.8x\n", 
+          context->slavelist[slave].SMtype[1], 
+          context->slavelist[slave].SM[1].StartAddr, 
+          context->slavelist[slave].SM[1].SMflags);   
+   }
+   /* program SM2 to SMx */
+   for( nSM = 2 ; nSM < EC_MAXSM ; nSM++ )
+   {   
+      if (context->slavelist[slave].SM[nSM].StartAddr)
+      {
+         /* check if SM length is zero -> clear enable flag */
+         if( context->slavelist[slave].SM[nSM].SMlength == 0) 
+         {
+            context->slavelist[slave].SM[nSM].SMflags = 
+               htoel( etohl(context->slavelist[slave].SM[nSM].SMflags) & EC_SMENABLEMASK);
+         }
+         ecx_FPWR(context->port, configadr, ECT_REG_SM0 + (nSM * sizeof(ec_smt)),
+            sizeof(ec_smt), &context->slavelist[slave].SM[nSM], EC_TIMEOUTRET3);
+         EC_PRINT("    SM%d Type:%d StartAddr:%4.4x Flags:%8.8x\n", nSM,
+             context->slavelist[slave].SMtype[nSM], 
+             context->slavelist[slave].SM[nSM].StartAddr, 
+             context->slavelist[slave].SM[nSM].SMflags);   
+      }
+   }
+   if (context->slavelist[slave].Ibits > 7)
+   {
+      context->slavelist[slave].Ibytes = (context->slavelist[slave].Ibits + 7) / 8;
+   }
+   if (context->slavelist[slave].Obits > 7)
+   {
+      context->slavelist[slave].Obytes = (context->slavelist[slave].Obits + 7) / 8;
+   }
+}
+
+/** Create the output mapping of a slave at the current logical address
+ * and program its FMMUs.
+ *
+ * @param[in]  context        = context struct
+ * @param[out] pIOmap     = pointer to IOmap   
+ * @param[in]  group      = group that is mapped
+ * @param[in]  slave      = slave number
+ * @param[in,out] pLogAddr = next free logical address
+ * @param[in,out] pBitPos  = next free bit in logical address
+ */
+static void ecx_config_create_output_mappings(ecx_contextt *context, void *pIOmap, uint8 group,
+                                              uint16 slave, uint32 *pLogAddr, uint8 *pBitPos)
+{
+   uint16 configadr;
+   int BitCount, ByteCount, FMMUsize, FMMUdone;
+   uint16 SMlength, EndAddr;
+   uint8 SMc, FMMUc;
+   uint32 LogAddr;
+   uint8 BitPos;
+
+   configadr = context->slavelist[slave].configadr;
+   LogAddr = *pLogAddr;
+   BitPos = *pBitPos;
+   FMMUc = context->slavelist[slave].FMMUunused;
+   SMc = 0;
+   BitCount = 0;
+   ByteCount = 0;
+   EndAddr = 0;
+   FMMUsize = 0;
+   FMMUdone = 0;
+   /* create output mapping */
+   if (context->slavelist[slave].Obits)
+   {
+      EC_PRINT("  OUTPUT MAPPING\n");
+      /* search for SM that contribute to the output mapping */
+      while ( (SMc < (EC_MAXSM - 1)) && (FMMUdone < ((context->slavelist[slave].Obits + 7) / 8)))
+      {   
+         EC_PRINT("    FMMU %d\n", FMMUc);
+         while ( (SMc < (EC_MAXSM - 1)) && (context->slavelist[slave].SMtype[SMc] != 3)) SMc++;
+         EC_PRINT("      SM%d\n", SMc);
+         context->slavelist[slave].FMMU[FMMUc].PhysStart = 
+            context->slavelist[slave].SM[SMc].StartAddr;
+         SMlength = etohs(context->slavelist[slave].SM[SMc].SMlength);
+         ByteCount += SMlength;
+         BitCount += SMlength * 8;
+         EndAddr = etohs(context->slavelist[slave].SM[SMc].StartAddr) + SMlength;
+         while ( (BitCount < context->slavelist[slave].Obits) && (SMc < (EC_MAXSM - 1)) ) /* more SM for output */
+         {
+            SMc++;
+            while ( (SMc < (EC_MAXSM - 1)) && (context->slavelist[slave].SMtype[SMc] != 3)) SMc++;
+            /* if addresses from more SM connect use one FMMU otherwise break up in mutiple FMMU */
+            if ( etohs(context->slavelist[slave].SM[SMc].StartAddr) > EndAddr ) 
+            {
+               break;
+            }
+            EC_PRINT("      SM%d\n", SMc);
+            SMlength = etohs(context->slavelist[slave].SM[SMc].SMlength);
+            ByteCount += SMlength;
+            BitCount += SMlength * 8;
+            EndAddr = etohs(context->slavelist[slave].SM[SMc].StartAddr) + SMlength;               
+         }   
+
+         /* bit oriented slave */
+         if (!context->slavelist[slave].Obytes)
+         {   
+            context->slavelist[slave].FMMU[FMMUc].LogStart = htoel(LogAddr);
+            context->slavelist[slave].FMMU[FMMUc].LogStartbit = BitPos;
+            BitPos += context->slavelist[slave].Obits - 1;
+            if (BitPos > 7)
+            {
+               LogAddr++;
+               BitPos -= 8;
+            }   
+            FMMUsize = LogAddr - etohl(context->slavelist[slave].FMMU[FMMUc].LogStart) + 1;
+            context->slavelist[slave].FMMU[FMMUc].LogLength = htoes(FMMUsize);
+            context->slavelist[slave].FMMU[FMMUc].LogEndbit = BitPos;
+            BitPos ++;
+            if (BitPos > 7)
+            {
+               LogAddr++;
+               BitPos -= 8;
+            }   
+         }
+         /* byte oriented slave */
+         else
+         {
+            if (BitPos)
+            {
+               LogAddr++;
+               BitPos = 0;
+            }   
+            context->slavelist[slave].FMMU[FMMUc].LogStart = htoel(LogAddr);
+            context->slavelist[slave].FMMU[FMMUc].LogStartbit = BitPos;
+            BitPos = 7;
+            FMMUsize = ByteCount;
+            if ((FMMUsize + FMMUdone)> (int)context->slavelist[slave].Obytes)
+            {
+               FMMUsize = context->slavelist[slave].Obytes - FMMUdone;
+            }
+            LogAddr += FMMUsize;
+            context->slavelist[slave].FMMU[FMMUc].LogLength = htoes(FMMUsize);
+            context->slavelist[slave].FMMU[FMMUc].LogEndbit = BitPos;
+            BitPos = 0;
+         }
+         FMMUdone += FMMUsize;
+         context->slavelist[slave].FMMU[FMMUc].PhysStartBit = 0;
+         context->slavelist[slave].FMMU[FMMUc].FMMUtype = 2;
+         context->slavelist[slave].FMMU[FMMUc].FMMUactive = 1;
+         /* program FMMU for output */
+         ecx_FPWR(context->port, configadr, ECT_REG_FMMU0 + (sizeof(ec_fmmut) * FMMUc),
+            sizeof(ec_fmmut), &(context->slavelist[slave].FMMU[FMMUc]), EC_TIMEOUTRET3);
+         context->grouplist[group].outputsWKC++;
+         if (!context->slavelist[slave].outputs)
+         {   
+            context->slavelist[slave].outputs = 
+               (uint8 *)(pIOmap) + etohl(context->slavelist[slave].FMMU[FMMUc].LogStart);
+            context->slavelist[slave].Ostartbit = 
+               context->slavelist[slave].FMMU[FMMUc].LogStartbit;
+            EC_PRINT("    slave %d Outputs %p startbit %d\n", 
+               slave, 
+               context->slavelist[slave].outputs, 
+               context->slavelist[slave].Ostartbit);
+         }
+         FMMUc++;
+      }   
+      context->slavelist[slave].FMMUunused = FMMUc;
+   }
+   *pLogAddr = LogAddr;
+   *pBitPos = BitPos;
+}
+
+/** Create the input mapping of a slave at the current logical address
+ * and program its FMMUs.
+ *
+ * @param[in]  context        = context struct
+ * @param[out] pIOmap     = pointer to IOmap   
+ * @param[in]  group      = group that is mapped
+ * @param[in]  slave      = slave number
+ * @param[in,out] pLogAddr = next free logical address
+ * @param[in,out] pBitPos  = next free bit in logical address
+ */
+static void ecx_config_create_input_mappings(ecx_contextt *context, void *pIOmap, uint8 group,
+                                             uint16 slave, uint32 *pLogAddr, uint8 *pBitPos)
+{
+   uint16 configadr;
+   int BitCount, ByteCount, FMMUsize, FMMUdone;
+   uint16 SMlength, EndAddr;
+   uint8 SMc, FMMUc;
+   uint32 LogAddr;
+   uint8 BitPos;
+
+   configadr = context->slavelist[slave].configadr;
+   LogAddr = *pLogAddr;
+   BitPos = *pBitPos;
+   FMMUc = context->slavelist[slave].FMMUunused;
+   if (context->slavelist[slave].Obits) /* find free FMMU */
+   {
+      while ( context->slavelist[slave].FMMU[FMMUc].LogStart ) FMMUc++;
+   }
+   SMc = 0;
+   BitCount = 0;
+   ByteCount = 0;
+   EndAddr = 0;
+   FMMUsize = 0;
+   FMMUdone = 0;
+   /* create input mapping */
+   if (context->slavelist[slave].Ibits)
+   {
+      EC_PRINT(" =Slave %d, INPUT MAPPING\n", slave);
+      /* search for SM that contribute to the input mapping */
+      while ( (SMc < (EC_MAXSM - 1)) && (FMMUdone < ((context->slavelist[slave].Ibits + 7) / 8)))
+      {   
+         EC_PRINT("    FMMU %d\n", FMMUc);
+         while ( (SMc < (EC_MAXSM - 1)) && (context->slavelist[slave].SMtype[SMc] != 4)) SMc++;
+         EC_PRINT("      SM%d\n", SMc);
+         context->slavelist[slave].FMMU[FMMUc].PhysStart = 
+            context->slavelist[slave].SM[SMc].StartAddr;
+         SMlength = etohs(context->slavelist[slave].SM[SMc].SMlength);
+         ByteCount += SMlength;
+         BitCount += SMlength * 8;
+         EndAddr = etohs(context->slavelist[slave].SM[SMc].StartAddr) + SMlength;
+         while ( (BitCount < context->slavelist[slave].Ibits) && (SMc < (EC_MAXSM - 1)) ) /* more SM for input */
+         {
+            SMc++;
+            while ( (SMc < (EC_MAXSM - 1)) && (context->slavelist[slave].SMtype[SMc] != 4)) SMc++;
+            /* if addresses from more SM connect use one FMMU otherwise break up in mutiple FMMU */
+            if ( etohs(context->slavelist[slave].SM[SMc].StartAddr) > EndAddr ) 
+            {
+               break;
+            }
+            EC_PRINT("      SM%d\n", SMc);
+            SMlength = etohs(context->slavelist[slave].SM[SMc].SMlength);
+            ByteCount += SMlength;
+            BitCount += SMlength * 8;
+            EndAddr = etohs(context->slavelist[slave].SM[SMc].StartAddr) + SMlength;               
+         }   
+
+         /* bit oriented slave */
+         if (!context->slavelist[slave].Ibytes)
+         {   
+            context->slavelist[slave].FMMU[FMMUc].LogStart = htoel(LogAddr);
+            context->slavelist[slave].FMMU[FMMUc].LogStartbit = BitPos;
+            BitPos += context->slavelist[slave].Ibits - 1;
+            if (BitPos > 7)
+            {
+               LogAddr++;
+               BitPos -= 8;
+            }   
+            FMMUsize = LogAddr - etohl(context->slavelist[slave].FMMU[FMMUc].LogStart) + 1;
+            context->slavelist[slave].FMMU[FMMUc].LogLength = htoes(FMMUsize);
+            context->slavelist[slave].FMMU[FMMUc].LogEndbit = BitPos;
+            BitPos ++;
+            if (BitPos > 7)
+            {
+               LogAddr++;
+               BitPos -= 8;
+            }   
+         }
+         /* byte oriented slave */
+         else
+         {
+            if (BitPos)
+            {
+               LogAddr++;
+               BitPos = 0;
+            }   
+            context->slavelist[slave].FMMU[FMMUc].LogStart = htoel(LogAddr);
+            context->slavelist[slave].FMMU[FMMUc].LogStartbit = BitPos;
+            BitPos = 7;
+            FMMUsize = ByteCount;
+            if ((FMMUsize + FMMUdone)> (int)context->slavelist[slave].Ibytes)
+            {
+               FMMUsize = context->slavelist[slave].Ibytes - FMMUdone;
+            }
+            LogAddr += FMMUsize;
+            context->slavelist[slave].FMMU[FMMUc].LogLength = htoes(FMMUsize);
+            context->slavelist[slave].FMMU[FMMUc].LogEndbit = BitPos;
+            BitPos = 0;
+         }
+         FMMUdone += FMMUsize;
+         if (context->slavelist[slave].FMMU[FMMUc].LogLength)
+         {   
+            context->slavelist[slave].FMMU[FMMUc].PhysStartBit = 0;
+            context->slavelist[slave].FMMU[FMMUc].FMMUtype = 1;
+            context->slavelist[slave].FMMU[FMMUc].FMMUactive = 1;
+            /* program FMMU for input */
+            ecx_FPWR(context->port, configadr, ECT_REG_FMMU0 + (sizeof(ec_fmmut) * FMMUc), 
+               sizeof(ec_fmmut), &(context->slavelist[slave].FMMU[FMMUc]), EC_TIMEOUTRET3);
+            /* add one for an input FMMU */
+            context->grouplist[group].inputsWKC++;
+         }   
+         if (!context->slavelist[slave].inputs)
+         {   
+            context->slavelist[slave].inputs = 
+               (uint8 *)(pIOmap) + etohl(context->slavelist[slave].FMMU[FMMUc].LogStart);
+            context->slavelist[slave].Istartbit = 
+               context->slavelist[slave].FMMU[FMMUc].LogStartbit;
+            EC_PRINT("    Inputs %p startbit %d\n", 
+               context->slavelist[slave].inputs, 
+               context->slavelist[slave].Istartbit);
+         }
+         FMMUc++;
+      }   
+      context->slavelist[slave].FMMUunused = FMMUc;
+   }
+   *pLogAddr = LogAddr;
+   *pBitPos = BitPos;
+}
+
+/** Cut the logical range of a group in IO segments of at most maxsize
+ * bytes. The logical sizes of the slaves, all outputs first and then all
+ * inputs, are added to a segment until the next one does not fit, so a
+ * segment never breaks the SM of a slave.
+ *
+ * @param[in]  context        = context struct
+ * @param[in]  group      = group
+ * @param[in]  maxsize    = max. segment size
+ * @param[out] IOsegment  = segment sizes, NULL to count only
+ * @return Number of segments
+ */
+static uint16 ecx_config_cut_segments(ecx_contextt *context, uint8 group, uint32 maxsize,
+                                      uint32 *IOsegment)
+{
+   ec_slavet *sl;
+   uint16 slave, nsegments = 0;
+   uint32 size = 0, diff;
+   int pass;
+
+   for (pass = 0; pass < 2; pass++)
+   {
+      for (slave = 1; slave <= *(context->slavecount); slave++)
+      {
+         sl = &context->slavelist[slave];
+         if (group && (group != sl->group))
+         {
+            continue;
+         }
+         diff = pass ? sl->Ilogsize : sl->Ologsize;
+         if (size && ((size + diff) > maxsize) && (nsegments < (EC_MAXIOSEGMENTS - 1)))
+         {
+            if (IOsegment)
+            {
+               IOsegment[nsegments] = size;
+            }
+            nsegments++;
+            size = 0;
+         }
+         size += diff;
+      }
+   }
+   if (IOsegment)
+   {
+      IOsegment[nsegments] = size;
+   }
+
+   return nsegments + 1;
+}
+
+/** Segment the logical range of a mapped group in IO segments, one
+ * datagram each. Called by the IOmap configuration with the group option
+ * balancesegments, call again and rebuild the frame plan to change the
+ * segmentation of a mapped group.
+ * Without balance every segment is filled up to the maximum datagram size,
+ * which gives the least number of segments, but the last one can be
+ * almost empty. With balance the same number of segments is kept and the
+ * largest segment is made as small as possible, so the frames have about
+ * equal size. Segments are only cut between the logical sizes of the
+ * slaves, see ec_slavet Ologsize and Ilogsize.
+ *
+ * @param[in]  context        = context struct
+ * @param[in]  group      = group
+ * @param[in]  balance    = TRUE to balance the segment sizes
+ * @return Number of segments
+ */
+int ecx_config_segment(ecx_contextt *context, uint8 group, boolean balance)
+{
+   ec_groupt *grp;
+   ec_slavet *sl;
+   uint16 slave, nsegments, i;
+   uint32 maxsize, low, high, mid, total = 0, largest = 0, obytes = 0, start;
+
+   if (group >= context->maxgroup)
+   {
+      return 0;
+   }
+   grp = &context->grouplist[group];
+   for (slave = 1; slave <= *(context->slavecount); slave++)
+   {
+      sl = &context->slavelist[slave];
+      if (!group || (group == sl->group))
+      {
+         obytes += sl->Ologsize;
+         total += sl->Ologsize + sl->Ilogsize;
+         largest = (sl->Ologsize > largest) ? sl->Ologsize : largest;
+         largest = (sl->Ilogsize > largest) ? sl->Ilogsize : largest;
+      }
+   }
+   maxsize = EC_MAXLRWDATA - EC_FIRSTDCDATAGRAM;
+   nsegments = ecx_config_cut_segments(context, group, maxsize, NULL);
+   if (balance && (nsegments > 1) && (nsegments < EC_MAXIOSEGMENTS) && (largest <= maxsize))
+   {
+      /* smallest max. size that still needs no more segments */
+      low = (total + nsegments - 1) / nsegments;
+      low = (largest > low) ? largest : low;
+      high = maxsize;
+      while (low < high)
+      {
+         mid = low + ((high - low) / 2);
+         if (ecx_config_cut_segments(context, group, mid, NULL) <= nsegments)
+         {
+            high = mid;
+         }
+         else
+         {
+            low = mid + 1;
+         }
+      }
+      maxsize = low;
+   }
+   grp->nsegments = ecx_config_cut_segments(context, group, maxsize, grp->IOsegment);
+   grp->Isegment = 0;
+   grp->Ioffset = 0;
+   if (!grp->overlap)
+   {
+      /* segment holding the first input byte and its offset there */
+      start = 0;
+      for (i = 0; (i < (grp->nsegments - 1)) && ((start + grp->IOsegment[i]) <= obytes); i++)
+      {
+         start += grp->IOsegment[i];
+      }
+      grp->Isegment = i;
+      grp->Ioffset = (uint16)(obytes - start);
+   }
+   EC_PRINT(" =Group %d, %d IO segments of max. %d bytes\n", group, grp->nsegments, maxsize);
+
+   return grp->nsegments;
+}
+
+/** Request SAFE_OP of a mapped slave and add it to the group totals.
+ *
+ * @param[in]  context        = context struct
+ * @param[in]  group      = group that is mapped
+ * @param[in]  slave      = slave number
+ */
+static void ecx_config_finish_slave(ecx_contextt *context, uint8 group, uint16 slave)
+{
+   uint16 configadr;
+
+   configadr = context->slavelist[slave].configadr;
+   ecx_eeprom2pdi(context, slave); /* set Eeprom control to PDI */         
+   ecx_FPWRw(context->port, configadr, ECT_REG_ALCTL, htoes(EC_STATE_SAFE_OP) , EC_TIMEOUTRET3); /* set safeop status */
+            
+   if (context->slavelist[slave].blockLRW)
+   {    
+      context->grouplist[group].blockLRW++;                     
+   }
+   context->grouplist[group].Ebuscurrent += context->slavelist[slave].Ebuscurrent;
+}
+
+/** Map a register of a slave with a spare FMMU for reading.
+ *
+ * @param[in]  context        = context struct
+ * @param[in]  slave      = slave number
+ * @param[in]  nfmmu      = number of FMMUs of the slave
+ * @param[in]  LogAddr    = logical address
+ * @param[in]  reg        = register address
+ * @param[in]  length     = register length in bytes
+ * @return TRUE if mapped, FALSE if no spare FMMU
+ */
+static boolean ecx_config_map_register(ecx_contextt *context, uint16 slave, uint8 nfmmu,
+                                       uint32 LogAddr, uint16 reg, uint16 length)
+{
+   ec_slavet *sl;
+   uint8 FMMUc;
+   int wkc;
+
+   sl = &context->slavelist[slave];
+   FMMUc = sl->FMMUunused;
+   while ((FMMUc < EC_MAXFMMU) && sl->FMMU[FMMUc].FMMUactive)
+   {
+      FMMUc++;
+   }
+   if ((FMMUc >= EC_MAXFMMU) || (FMMUc >= nfmmu))
+   {
+      EC_PRINT(" =Slave %d, no spare FMMU for register %4.4x\n", slave, reg);
+      return FALSE;
+   }
+   sl->FMMU[FMMUc].LogStart = htoel(LogAddr);
+   sl->FMMU[FMMUc].LogLength = htoes(length);
+   sl->FMMU[FMMUc].LogStartbit = 0;
+   sl->FMMU[FMMUc].LogEndbit = 7;
+   sl->FMMU[FMMUc].PhysStart = htoes(reg);
+   sl->FMMU[FMMUc].PhysStartBit = 0;
+   sl->FMMU[FMMUc].FMMUtype = 1;
+   sl->FMMU[FMMUc].FMMUactive = 1;
+   wkc = ecx_FPWR(context->port, sl->configadr, ECT_REG_FMMU0 + (sizeof(ec_fmmut) * FMMUc),
+                  sizeof(ec_fmmut), &(sl->FMMU[FMMUc]), EC_TIMEOUTRET3);
+   if (wkc <= 0)
+   {
+      sl->FMMU[FMMUc].FMMUactive = 0;
+      return FALSE;
+   }
+   EC_PRINT(" =Slave %d, register %4.4x FMMU %d\n", slave, reg, FMMUc);
+   sl->FMMUunused = FMMUc + 1;
+
+   return TRUE;
+}
+
+/** Map the AL status register of every slave of the group (mapstatus) and
+ * the SM1 status register of every mailbox slave (mapmbxstatus) with a
+ * spare FMMU into a logical area after the process data. The area takes 2
+ * bytes per AL status and 1 byte per SM1 status in the IOmap and is
+ * followed by as many zero bytes, these are sent by the cyclic read so a
+ * lost slave reads 0. Slaves without spare FMMU are left out.
+ *
+ * @param[in]  context        = context struct
+ * @param[out] pIOmap     = pointer to IOmap
+ * @param[in]  group      = group that is mapped
+ * @param[in]  LogAddr    = logical start address of the area
+ * @param[in]  offset     = offset of the area in the IOmap
+ * @return IOmap bytes used
+ */
+static uint32 ecx_config_map_status(ecx_contextt *context, void *pIOmap, uint8 group,
+                                    uint32 LogAddr, uint32 offset)
+{
+   ec_groupt *grp;
+   ec_slavet *sl;
+   uint16 slave;
+   uint8 nfmmu;
+   boolean mapped;
+
+   grp = &context->grouplist[group];
+   grp->status = (uint8 *)pIOmap + offset;
+   grp->statuslogaddr = LogAddr;
+   grp->statusbytes = 0;
+   grp->statusWKC = 0;
+   for (slave = 1; slave <= *(context->slavecount); slave++)
+   {
+      sl = &context->slavelist[slave];
+      if (group && (group != sl->group))
+      {
+         continue;
+      }
+      sl->alstatus = NULL;
+      sl->mbxstatus = NULL;
+      mapped = FALSE;
+      nfmmu = 0;
+      ecx_FPRD(context->port, sl->configadr, ECT_REG_FMMUCNT, sizeof(nfmmu), &nfmmu, EC_TIMEOUTRET3);
+      if (grp->mapstatus &&
+          ecx_config_map_register(context, slave, nfmmu, LogAddr, ECT_REG_ALSTAT, 2))
+      {
+         sl->alstatus = grp->status + grp->statusbytes;
+         grp->statusbytes += 2;
+         LogAddr += 2;
+         mapped = TRUE;
+      }
+      if (grp->mapmbxstatus && sl->mbx_rl &&
+          ecx_config_map_register(context, slave, nfmmu, LogAddr, ECT_REG_SM1STAT, 1))
+      {
+         sl->mbxstatus = grp->status + grp->statusbytes;
+         grp->statusbytes += 1;
+         LogAddr += 1;
+         mapped = TRUE;
+      }
+      /* one work counter per slave, however many of its registers are mapped */
+      if (mapped)
+      {
+         grp->statusWKC++;
+      }
+   }
+   memset(grp->status, 0, grp->statusbytes * 2);
+
+   return grp->statusbytes * 2;
+}
+
+/** Bring a slave to PRE_OP before mapping and run its configuration hook.
+ *
+ * @param[in]  context        = context struct
+ * @param[in]  slave      = slave number
+ */
+static void ecx_config_prepare_slave(ecx_contextt *context, uint16 slave)
+{
+   ecx_statecheck(context, slave, EC_STATE_PRE_OP, EC_TIMEOUTSTATE); /* check state change pre-op */
+
+   EC_PRINT(" >Slave %d, configadr %x, state %2.2x\n",
+            slave, context->slavelist[slave].configadr, context->slavelist[slave].state);
+
+   /* execute special slave configuration hook Pre-Op to Safe-OP */
+   if(context->slavelist[slave].PO2SOconfig) /* only if registered */
+   {
+      context->slavelist[slave].PO2SOconfig(slave);         
+   }
+}
+
 /** Map all PDOs in one group of slaves to IOmap.
+ * Outputs and inputs are mapped back to back in the logical address space,
+ * all outputs of the group first. With mapstatus or mapmbxstatus set in the
+ * group the status area follows, see ecx_config_map_status().
  *
  * @param[in]  context        = context struct
  * @param[out] pIOmap     = pointer to IOmap   
@@ -531,271 +1221,43 @@ int ecx_config_init(ecx_contextt *context, uint8 usetable)
  */
 int ecx_config_map_group(ecx_contextt *context, void *pIOmap, uint8 group)
 {
-   uint16 slave, configadr;
-   int Isize, Osize, BitCount, ByteCount, FMMUsize, FMMUdone;
-   uint16 SMlength, EndAddr;
+   uint16 slave;
    uint8 BitPos;
-   uint8 SMc, FMMUc;
    uint32 LogAddr = 0;
    uint32 oLogAddr = 0;
-   uint32 diff;
-   int nSM, rval;
-   ec_eepromPDOt eepPDO;
-   uint16 currentsegment = 0;
-   uint32 segmentsize = 0;
+   uint32 diff, size;
+   uint16 last;
+   ec_groupt *grp;
 
    if ((*(context->slavecount) > 0) && (group < context->maxgroup))
    {   
       EC_PRINT("ec_config_map_group IOmap:%p group:%d\n", pIOmap, group);
-      LogAddr = context->grouplist[group].logstartaddr;
+      grp = &context->grouplist[group];
+      LogAddr = grp->logstartaddr;
       oLogAddr = LogAddr;
       BitPos = 0;
-      context->grouplist[group].nsegments = 0;
-      context->grouplist[group].outputsWKC = 0;
-      context->grouplist[group].inputsWKC = 0;
+      grp->nsegments = 0;
+      grp->outputsWKC = 0;
+      grp->inputsWKC = 0;
+      grp->overlap = FALSE;
+      last = 0;
 
       /* find output mapping of slave and program FMMU */
       for (slave = 1; slave <= *(context->slavecount); slave++)
       {
-         configadr = context->slavelist[slave].configadr;
-
-         ecx_statecheck(context, slave, EC_STATE_PRE_OP, EC_TIMEOUTSTATE); /* check state change pre-op */
-
-         EC_PRINT(" >Slave %d, configadr %x, state %2.2x\n",
-                  slave, context->slavelist[slave].configadr, context->slavelist[slave].state);
-
-         /* execute special slave configuration hook Pre-Op to Safe-OP */
-         if(context->slavelist[slave].PO2SOconfig) /* only if registered */
-         {
-            context->slavelist[slave].PO2SOconfig(slave);         
-         }
+         ecx_config_prepare_slave(context, slave);
          if (!group || (group == context->slavelist[slave].group))
          {   
-         
-            /* if slave not found in configlist find IO mapping in slave self */
-            if (!context->slavelist[slave].configindex)
-            {
-               Isize = 0;
-               Osize = 0;
-               if (context->slavelist[slave].mbx_proto & ECT_MBXPROT_COE) /* has CoE */
-               {
-                  rval = 0;
-                  if (context->slavelist[slave].CoEdetails & ECT_COEDET_SDOCA) /* has Complete Access */
-                     /* read PDO mapping via CoE and use Complete Access */
-                  {
-                     rval = ecx_readPDOmapCA(context, slave, &Osize, &Isize);
-                  }
-                  if (!rval) /* CA not available or not succeeded */
-                  {
-                     /* read PDO mapping via CoE */
-                     rval = ecx_readPDOmap(context, slave, &Osize, &Isize);
-                  }
-                  EC_PRINT("  CoE Osize:%d Isize:%d\n", Osize, Isize);
-               }
-               if ((!Isize && !Osize) && (context->slavelist[slave].mbx_proto & ECT_MBXPROT_SOE)) /* has SoE */
-               {
-                  /* read AT / MDT mapping via SoE */
-                  rval = ecx_readIDNmap(context, slave, &Osize, &Isize);
-                  context->slavelist[slave].SM[2].SMlength = htoes((Osize + 7) / 8);
-                  context->slavelist[slave].SM[3].SMlength = htoes((Isize + 7) / 8);
-                  EC_PRINT("  SoE Osize:%d Isize:%d\n", Osize, Isize);
-               }
-               if (!Isize && !Osize) /* find PDO mapping by SII */
-               {
-                  memset(&eepPDO, 0, sizeof(eepPDO));
-                  Isize = (int)ecx_siiPDO(context, slave, &eepPDO, 0);
-                  EC_PRINT("  SII Isize:%d\n", Isize);               
-                  for( nSM=0 ; nSM < EC_MAXSM ; nSM++ )
-                  {   
-                     if (eepPDO.SMbitsize[nSM] > 0)
-                     {   
-                        context->slavelist[slave].SM[nSM].SMlength =  htoes((eepPDO.SMbitsize[nSM] + 7) / 8);
-                        context->slavelist[slave].SMtype[nSM] = 4;
-                        EC_PRINT("    SM%d length %d\n", nSM, eepPDO.SMbitsize[nSM]);
-                     }   
-                  }   
-                  Osize = (int)ecx_siiPDO(context, slave, &eepPDO, 1);
-                  EC_PRINT("  SII Osize:%d\n", Osize);               
-                  for( nSM=0 ; nSM < EC_MAXSM ; nSM++ )
-                  {   
-                     if (eepPDO.SMbitsize[nSM] > 0)
-                     {   
-                        context->slavelist[slave].SM[nSM].SMlength =  htoes((eepPDO.SMbitsize[nSM] + 7) / 8);
-                        context->slavelist[slave].SMtype[nSM] = 3;
-                        EC_PRINT("    SM%d length %d\n", nSM, eepPDO.SMbitsize[nSM]);
-                     }   
-                  }   
-               }
-               context->slavelist[slave].Obits = Osize;
-               context->slavelist[slave].Ibits = Isize;
-               EC_PRINT("     ISIZE:%d %d OSIZE:%d\n", 
-                  context->slavelist[slave].Ibits, Isize,context->slavelist[slave].Obits);    
-            }
-
-            EC_PRINT("  SM programming\n");  
-            if (!context->slavelist[slave].mbx_l && context->slavelist[slave].SM[0].StartAddr)
-            {
-               ecx_FPWR(context->port, configadr, ECT_REG_SM0, 
-                  sizeof(ec_smt), &(context->slavelist[slave].SM[0]), EC_TIMEOUTRET3);
-               EC_PRINT("    SM0 Type:%d StartAddr:%4.4x Flags:%8.8x\n", 
-                   context->slavelist[slave].SMtype[0], 
-                   context->slavelist[slave].SM[0].StartAddr, 
-                   context->slavelist[slave].SM[0].SMflags);   
-            }
-            if (!context->slavelist[slave].mbx_l && context->slavelist[slave].SM[1].StartAddr)
-            {
-               ecx_FPWR(context->port, configadr, ECT_REG_SM1, 
-                  sizeof(ec_smt), &context->slavelist[slave].SM[1], EC_TIMEOUTRET3);
-               EC_PRINT("    SM1 Type:%d StartAddr:%4.4x Flags:%8.8x\n", 
-                   context->slavelist[slave].SMtype[1], 
-                   context->slavelist[slave].SM[1].StartAddr, 
-                   context->slavelist[slave].SM[1].SMflags);   
-            }
-            /* program SM2 to SMx */
-            for( nSM = 2 ; nSM < EC_MAXSM ; nSM++ )
-            {   
-               if (context->slavelist[slave].SM[nSM].StartAddr)
-               {
-                  /* check if SM length is zero -> clear enable flag */
-                  if( context->slavelist[slave].SM[nSM].SMlength == 0) 
-                  {
-                     context->slavelist[slave].SM[nSM].SMflags = 
-                        htoel( etohl(context->slavelist[slave].SM[nSM].SMflags) & EC_SMENABLEMASK);
-                  }
-                  ecx_FPWR(context->port, configadr, ECT_REG_SM0 + (nSM * sizeof(ec_smt)),
-                     sizeof(ec_smt), &context->slavelist[slave].SM[nSM], EC_TIMEOUTRET3);
-                  EC_PRINT("    SM%d Type:%d StartAddr:%4.4x Flags:%8.8x\n", nSM,
-                      context->slavelist[slave].SMtype[nSM], 
-                      context->slavelist[slave].SM[nSM].StartAddr, 
-                      context->slavelist[slave].SM[nSM].SMflags);   
-               }
-            }
-            if (context->slavelist[slave].Ibits > 7)
-            {
-               context->slavelist[slave].Ibytes = (context->slavelist[slave].Ibits + 7) / 8;
-            }
-            if (context->slavelist[slave].Obits > 7)
-            {
-               context->slavelist[slave].Obytes = (context->slavelist[slave].Obits + 7) / 8;
-            }
-            FMMUc = context->slavelist[slave].FMMUunused;
-            SMc = 0;
-            BitCount = 0;
-            ByteCount = 0;
-            EndAddr = 0;
-            FMMUsize = 0;
-            FMMUdone = 0;
-            /* create output mapping */
+            ecx_config_find_mappings(context, slave);
+            ecx_config_create_output_mappings(context, pIOmap, group, slave, &LogAddr, &BitPos);
+            diff = LogAddr - oLogAddr;
+            oLogAddr = LogAddr;
+            context->slavelist[slave].Ologsize = 0;
+            context->slavelist[slave].Ilogsize = 0;
             if (context->slavelist[slave].Obits)
             {
-               EC_PRINT("  OUTPUT MAPPING\n");
-               /* search for SM that contribute to the output mapping */
-               while ( (SMc < (EC_MAXSM - 1)) && (FMMUdone < ((context->slavelist[slave].Obits + 7) / 8)))
-               {   
-                  EC_PRINT("    FMMU %d\n", FMMUc);
-                  while ( (SMc < (EC_MAXSM - 1)) && (context->slavelist[slave].SMtype[SMc] != 3)) SMc++;
-                  EC_PRINT("      SM%d\n", SMc);
-                  context->slavelist[slave].FMMU[FMMUc].PhysStart = 
-                     context->slavelist[slave].SM[SMc].StartAddr;
-                  SMlength = etohs(context->slavelist[slave].SM[SMc].SMlength);
-                  ByteCount += SMlength;
-                  BitCount += SMlength * 8;
-                  EndAddr = etohs(context->slavelist[slave].SM[SMc].StartAddr) + SMlength;
-                  while ( (BitCount < context->slavelist[slave].Obits) && (SMc < (EC_MAXSM - 1)) ) /* more SM for output */
-                  {
-                     SMc++;
-                     while ( (SMc < (EC_MAXSM - 1)) && (context->slavelist[slave].SMtype[SMc] != 3)) SMc++;
-                     /* if addresses from more SM connect use one FMMU otherwise break up in mutiple FMMU */
-                     if ( etohs(context->slavelist[slave].SM[SMc].StartAddr) > EndAddr ) 
-                     {
-                        break;
-                     }
-                     EC_PRINT("      SM%d\n", SMc);
-                     SMlength = etohs(context->slavelist[slave].SM[SMc].SMlength);
-                     ByteCount += SMlength;
-                     BitCount += SMlength * 8;
-                     EndAddr = etohs(context->slavelist[slave].SM[SMc].StartAddr) + SMlength;               
-                  }   
-
-                  /* bit oriented slave */
-                  if (!context->slavelist[slave].Obytes)
-                  {   
-                     context->slavelist[slave].FMMU[FMMUc].LogStart = htoel(LogAddr);
-                     context->slavelist[slave].FMMU[FMMUc].LogStartbit = BitPos;
-                     BitPos += context->slavelist[slave].Obits - 1;
-                     if (BitPos > 7)
-                     {
-                        LogAddr++;
-                        BitPos -= 8;
-                     }   
-                     FMMUsize = LogAddr - etohl(context->slavelist[slave].FMMU[FMMUc].LogStart) + 1;
-                     context->slavelist[slave].FMMU[FMMUc].LogLength = htoes(FMMUsize);
-                     context->slavelist[slave].FMMU[FMMUc].LogEndbit = BitPos;
-                     BitPos ++;
-                     if (BitPos > 7)
-                     {
-                        LogAddr++;
-                        BitPos -= 8;
-                     }   
-                  }
-                  /* byte oriented slave */
-                  else
-                  {
-                     if (BitPos)
-                     {
-                        LogAddr++;
-                        BitPos = 0;
-                     }   
-                     context->slavelist[slave].FMMU[FMMUc].LogStart = htoel(LogAddr);
-                     context->slavelist[slave].FMMU[FMMUc].LogStartbit = BitPos;
-                     BitPos = 7;
-                     FMMUsize = ByteCount;
-                     if ((FMMUsize + FMMUdone)> (int)context->slavelist[slave].Obytes)
-                     {
-                        FMMUsize = context->slavelist[slave].Obytes - FMMUdone;
-                     }
-                     LogAddr += FMMUsize;
-                     context->slavelist[slave].FMMU[FMMUc].LogLength = htoes(FMMUsize);
-                     context->slavelist[slave].FMMU[FMMUc].LogEndbit = BitPos;
-                     BitPos = 0;
-                  }
-                  FMMUdone += FMMUsize;
-                  context->slavelist[slave].FMMU[FMMUc].PhysStartBit = 0;
-                  context->slavelist[slave].FMMU[FMMUc].FMMUtype = 2;
-                  context->slavelist[slave].FMMU[FMMUc].FMMUactive = 1;
-                  /* program FMMU for output */
-                  ecx_FPWR(context->port, configadr, ECT_REG_FMMU0 + (sizeof(ec_fmmut) * FMMUc),
-                     sizeof(ec_fmmut), &(context->slavelist[slave].FMMU[FMMUc]), EC_TIMEOUTRET3);
-                  context->grouplist[group].outputsWKC++;
-                  if (!context->slavelist[slave].outputs)
-                  {   
-                     context->slavelist[slave].outputs = 
-                        (uint8 *)(pIOmap) + etohl(context->slavelist[slave].FMMU[FMMUc].LogStart);
-                     context->slavelist[slave].Ostartbit = 
-                        context->slavelist[slave].FMMU[FMMUc].LogStartbit;
-                     EC_PRINT("    slave %d Outputs %p startbit %d\n", 
-                        slave, 
-                        context->slavelist[slave].outputs, 
-                        context->slavelist[slave].Ostartbit);
-                  }
-                  FMMUc++;
-               }   
-               context->slavelist[slave].FMMUunused = FMMUc;
-               diff = LogAddr - oLogAddr;
-               oLogAddr = LogAddr;
-               if ((segmentsize + diff) > (EC_MAXLRWDATA - EC_FIRSTDCDATAGRAM))
-               {
-                  context->grouplist[group].IOsegment[currentsegment] = segmentsize;
-                  if (currentsegment < (EC_MAXIOSEGMENTS - 1))
-                  {
-                     currentsegment++;
-                     segmentsize = diff;   
-                  }
-               }
-               else
-               {
-                  segmentsize += diff;
-               }
+               context->slavelist[slave].Ologsize = diff;
+               last = slave;
             }
          }   
       }
@@ -804,25 +1266,11 @@ int ecx_config_map_group(ecx_contextt *context, void *pIOmap, uint8 group)
          LogAddr++;
          oLogAddr = LogAddr;
          BitPos = 0;
-         if ((segmentsize + 1) > (EC_MAXLRWDATA - EC_FIRSTDCDATAGRAM))
-         {
-            context->grouplist[group].IOsegment[currentsegment] = segmentsize;
-            if (currentsegment < (EC_MAXIOSEGMENTS - 1))
-            {
-               currentsegment++;
-               segmentsize = 1;   
-            }
-         }
-         else
-         {
-            segmentsize += 1;
-         }
+         /* the last byte holds bits of the last slave */
+         context->slavelist[last].Ologsize++;
       }   
-      context->grouplist[group].outputs = pIOmap;
-      context->grouplist[group].Obytes = LogAddr;
-      context->grouplist[group].nsegments = currentsegment + 1;
-      context->grouplist[group].Isegment = currentsegment;
-      context->grouplist[group].Ioffset = segmentsize;
+      grp->outputs = pIOmap;
+      grp->Obytes = LogAddr;
       if (!group)
       {   
          context->slavelist[0].outputs = pIOmap;
@@ -832,179 +1280,178 @@ int ecx_config_map_group(ecx_contextt *context, void *pIOmap, uint8 group)
       /* do input mapping of slave and program FMMUs */
       for (slave = 1; slave <= *(context->slavecount); slave++)
       {
-         configadr = context->slavelist[slave].configadr;
-         FMMUc = context->slavelist[slave].FMMUunused;
-         if (context->slavelist[slave].Obits) /* find free FMMU */
-         {
-            while ( context->slavelist[slave].FMMU[FMMUc].LogStart ) FMMUc++;
-         }
-         SMc = 0;
-         BitCount = 0;
-         ByteCount = 0;
-         EndAddr = 0;
-         FMMUsize = 0;
-         FMMUdone = 0;
-         /* create input mapping */
-         if (context->slavelist[slave].Ibits)
-         {
-            EC_PRINT(" =Slave %d, INPUT MAPPING\n", slave);
-            /* search for SM that contribute to the input mapping */
-            while ( (SMc < (EC_MAXSM - 1)) && (FMMUdone < ((context->slavelist[slave].Ibits + 7) / 8)))
-            {   
-               EC_PRINT("    FMMU %d\n", FMMUc);
-               while ( (SMc < (EC_MAXSM - 1)) && (context->slavelist[slave].SMtype[SMc] != 4)) SMc++;
-               EC_PRINT("      SM%d\n", SMc);
-               context->slavelist[slave].FMMU[FMMUc].PhysStart = 
-                  context->slavelist[slave].SM[SMc].StartAddr;
-               SMlength = etohs(context->slavelist[slave].SM[SMc].SMlength);
-               ByteCount += SMlength;
-               BitCount += SMlength * 8;
-               EndAddr = etohs(context->slavelist[slave].SM[SMc].StartAddr) + SMlength;
-               while ( (BitCount < context->slavelist[slave].Ibits) && (SMc < (EC_MAXSM - 1)) ) /* more SM for input */
-               {
-                  SMc++;
-                  while ( (SMc < (EC_MAXSM - 1)) && (context->slavelist[slave].SMtype[SMc] != 4)) SMc++;
-                  /* if addresses from more SM connect use one FMMU otherwise break up in mutiple FMMU */
-                  if ( etohs(context->slavelist[slave].SM[SMc].StartAddr) > EndAddr ) 
-                  {
-                     break;
-                  }
-                  EC_PRINT("      SM%d\n", SMc);
-                  SMlength = etohs(context->slavelist[slave].SM[SMc].SMlength);
-                  ByteCount += SMlength;
-                  BitCount += SMlength * 8;
-                  EndAddr = etohs(context->slavelist[slave].SM[SMc].StartAddr) + SMlength;               
-               }   
-
-               /* bit oriented slave */
-               if (!context->slavelist[slave].Ibytes)
-               {   
-                  context->slavelist[slave].FMMU[FMMUc].LogStart = htoel(LogAddr);
-                  context->slavelist[slave].FMMU[FMMUc].LogStartbit = BitPos;
-                  BitPos += context->slavelist[slave].Ibits - 1;
-                  if (BitPos > 7)
-                  {
-                     LogAddr++;
-                     BitPos -= 8;
-                  }   
-                  FMMUsize = LogAddr - etohl(context->slavelist[slave].FMMU[FMMUc].LogStart) + 1;
-                  context->slavelist[slave].FMMU[FMMUc].LogLength = htoes(FMMUsize);
-                  context->slavelist[slave].FMMU[FMMUc].LogEndbit = BitPos;
-                  BitPos ++;
-                  if (BitPos > 7)
-                  {
-                     LogAddr++;
-                     BitPos -= 8;
-                  }   
-               }
-               /* byte oriented slave */
-               else
-               {
-                  if (BitPos)
-                  {
-                     LogAddr++;
-                     BitPos = 0;
-                  }   
-                  context->slavelist[slave].FMMU[FMMUc].LogStart = htoel(LogAddr);
-                  context->slavelist[slave].FMMU[FMMUc].LogStartbit = BitPos;
-                  BitPos = 7;
-                  FMMUsize = ByteCount;
-                  if ((FMMUsize + FMMUdone)> (int)context->slavelist[slave].Ibytes)
-                  {
-                     FMMUsize = context->slavelist[slave].Ibytes - FMMUdone;
-                  }
-                  LogAddr += FMMUsize;
-                  context->slavelist[slave].FMMU[FMMUc].LogLength = htoes(FMMUsize);
-                  context->slavelist[slave].FMMU[FMMUc].LogEndbit = BitPos;
-                  BitPos = 0;
-               }
-               FMMUdone += FMMUsize;
-               if (context->slavelist[slave].FMMU[FMMUc].LogLength)
-               {   
-                  context->slavelist[slave].FMMU[FMMUc].PhysStartBit = 0;
-                  context->slavelist[slave].FMMU[FMMUc].FMMUtype = 1;
-                  context->slavelist[slave].FMMU[FMMUc].FMMUactive = 1;
-                  /* program FMMU for input */
-                  ecx_FPWR(context->port, configadr, ECT_REG_FMMU0 + (sizeof(ec_fmmut) * FMMUc), 
-                     sizeof(ec_fmmut), &(context->slavelist[slave].FMMU[FMMUc]), EC_TIMEOUTRET3);
-                  /* add one for an input FMMU */
-                  context->grouplist[group].inputsWKC++;
-               }   
-               if (!context->slavelist[slave].inputs)
-               {   
-                  context->slavelist[slave].inputs = 
-                     (uint8 *)(pIOmap) + etohl(context->slavelist[slave].FMMU[FMMUc].LogStart);
-                  context->slavelist[slave].Istartbit = 
-                     context->slavelist[slave].FMMU[FMMUc].LogStartbit;
-                  EC_PRINT("    Inputs %p startbit %d\n", 
-                     context->slavelist[slave].inputs, 
-                     context->slavelist[slave].Istartbit);
-               }
-               FMMUc++;
-            }   
-            context->slavelist[slave].FMMUunused = FMMUc;
+         if (!group || (group == context->slavelist[slave].group))
+         {   
+            ecx_config_create_input_mappings(context, pIOmap, group, slave, &LogAddr, &BitPos);
             diff = LogAddr - oLogAddr;
             oLogAddr = LogAddr;
-            if ((segmentsize + diff) > (EC_MAXLRWDATA - EC_FIRSTDCDATAGRAM))
+            if (context->slavelist[slave].Ibits)
             {
-               context->grouplist[group].IOsegment[currentsegment] = segmentsize;
-               if (currentsegment < (EC_MAXIOSEGMENTS - 1))
-               {
-                  currentsegment++;
-                  segmentsize = diff;   
-               }
+               context->slavelist[slave].Ilogsize = diff;
+               last = slave;
             }
-            else
-            {
-               segmentsize += diff;
-            }   
          }
-
-         ecx_eeprom2pdi(context, slave); /* set Eeprom control to PDI */         
-         ecx_FPWRw(context->port, configadr, ECT_REG_ALCTL, htoes(EC_STATE_SAFE_OP) , EC_TIMEOUTRET3); /* set safeop status */
-                  
-         if (context->slavelist[slave].blockLRW)
-         {    
-            context->grouplist[group].blockLRW++;                     
-         }
-         context->grouplist[group].Ebuscurrent += context->slavelist[slave].Ebuscurrent;
       }
       if (BitPos)
       {
          LogAddr++;
          oLogAddr = LogAddr;
          BitPos = 0;
-         if ((segmentsize + 1) > (EC_MAXLRWDATA - EC_FIRSTDCDATAGRAM))
+         context->slavelist[last].Ilogsize++;
+      }   
+      ecx_config_segment(context, group, grp->balancesegments);
+      grp->inputs = (uint8 *)(pIOmap) + grp->Obytes;
+      grp->Ibytes = LogAddr - grp->Obytes;
+      if (!group)
+      {   
+         context->slavelist[0].inputs = (uint8 *)(pIOmap) + context->slavelist[0].Obytes;
+         context->slavelist[0].Ibytes = LogAddr - context->slavelist[0].Obytes; /* store input bytes in master record */
+      }   
+      size = LogAddr - grp->logstartaddr;
+      grp->statusbytes = 0;
+      if (grp->mapstatus || grp->mapmbxstatus)
+      {
+         size += ecx_config_map_status(context, pIOmap, group, LogAddr, size);
+      }
+      for (slave = 1; slave <= *(context->slavecount); slave++)
+      {
+         if (!group || (group == context->slavelist[slave].group))
          {
-            context->grouplist[group].IOsegment[currentsegment] = segmentsize;
-            if (currentsegment < (EC_MAXIOSEGMENTS - 1))
+            ecx_config_finish_slave(context, group, slave);
+         }
+      }
+
+      ecx_frameplan_build(context, group);
+      EC_PRINT("IOmapSize %d, wire bytes per cycle %d\n", size,
+               ecx_frameplan_wirebytes(context, group, NULL));
+   
+      return size;
+   }
+   
+   return 0;
+}
+
+/** Map all PDOs in one group of slaves to IOmap with overlapping inputs
+ * and outputs. The inputs of a slave share the logical address range of
+ * its outputs, so a LRW only carries max(outputs, inputs) per slave.
+ * The IOmap holds all outputs of the group followed by a separate copy of
+ * the logical range for the inputs, the LRW response is copied there so it
+ * does not overwrite the outputs. Group Obytes and Ibytes are both the
+ * logical size. With mapstatus or mapmbxstatus set in the group the status
+ * area follows, see ecx_config_map_status().
+ *
+ * @param[in]  context        = context struct
+ * @param[out] pIOmap     = pointer to IOmap, 2 times the logical size
+ * @param[in]  group      = group to map, 0 = all groups   
+ * @return IOmap size
+ */
+int ecx_config_overlap_map_group(ecx_contextt *context, void *pIOmap, uint8 group)
+{
+   uint16 slave;
+   uint8 BitPos, sBitPos, oBitPos;
+   uint32 LogAddr = 0;
+   uint32 oLogAddr = 0;
+   uint32 sLogAddr, oEndAddr;
+   uint32 size, iomapsize;
+   uint16 last;
+   ec_groupt *grp;
+
+   if ((*(context->slavecount) > 0) && (group < context->maxgroup))
+   {   
+      EC_PRINT("ec_config_overlap_map_group IOmap:%p group:%d\n", pIOmap, group);
+      grp = &context->grouplist[group];
+      LogAddr = grp->logstartaddr;
+      oLogAddr = LogAddr;
+      BitPos = 0;
+      grp->nsegments = 0;
+      grp->outputsWKC = 0;
+      grp->inputsWKC = 0;
+      grp->overlap = TRUE;
+      last = 0;
+
+      for (slave = 1; slave <= *(context->slavecount); slave++)
+      {
+         ecx_config_prepare_slave(context, slave);
+         if (!group || (group == context->slavelist[slave].group))
+         {   
+            ecx_config_find_mappings(context, slave);
+            /* outputs and inputs both start at the same logical address */
+            sLogAddr = LogAddr;
+            sBitPos = BitPos;
+            ecx_config_create_output_mappings(context, pIOmap, group, slave, &LogAddr, &BitPos);
+            oEndAddr = LogAddr;
+            oBitPos = BitPos;
+            LogAddr = sLogAddr;
+            BitPos = sBitPos;
+            ecx_config_create_input_mappings(context, pIOmap, group, slave, &LogAddr, &BitPos);
+            /* continue after the larger of both */
+            if ((oEndAddr > LogAddr) || ((oEndAddr == LogAddr) && (oBitPos > BitPos)))
             {
-               currentsegment++;
-               segmentsize = 1;   
+               LogAddr = oEndAddr;
+               BitPos = oBitPos;
             }
-         }
-         else
+            context->slavelist[slave].Ologsize = 0;
+            context->slavelist[slave].Ilogsize = 0;
+            if (context->slavelist[slave].Obits || context->slavelist[slave].Ibits)
+            {
+               context->slavelist[slave].Ologsize = LogAddr - oLogAddr;
+               last = slave;
+            }
+            oLogAddr = LogAddr;
+         }   
+      }
+      if (BitPos)
+      {
+         LogAddr++;
+         oLogAddr = LogAddr;
+         BitPos = 0;
+         context->slavelist[last].Ologsize++;
+      }   
+      ecx_config_segment(context, group, grp->balancesegments);
+      size = LogAddr - grp->logstartaddr;
+      /* inputs live in their own copy of the logical range after the outputs */
+      for (slave = 1; slave <= *(context->slavecount); slave++)
+      {
+         if ((!group || (group == context->slavelist[slave].group)) &&
+             context->slavelist[slave].Ibits && context->slavelist[slave].inputs)
          {
-            segmentsize += 1;
+            context->slavelist[slave].inputs += size;
          }
-      }   
-      context->grouplist[group].IOsegment[currentsegment] = segmentsize;
-      context->grouplist[group].nsegments = currentsegment + 1;
-      context->grouplist[group].inputs = (uint8 *)(pIOmap) + context->grouplist[group].Obytes;
-      context->grouplist[group].Ibytes = LogAddr - context->grouplist[group].Obytes;
+      }
+      grp->outputs = pIOmap;
+      grp->Obytes = size;
+      grp->inputs = (uint8 *)(pIOmap) + size;
+      grp->Ibytes = size;
       if (!group)
       {   
-         context->slavelist[0].inputs = (uint8 *)(pIOmap) + context->slavelist[0].Obytes;
-         context->slavelist[0].Ibytes = LogAddr - context->slavelist[0].Obytes; /* store input bytes in master record */
+         context->slavelist[0].outputs = grp->outputs;
+         context->slavelist[0].Obytes = size;
+         context->slavelist[0].inputs = grp->inputs;
+         context->slavelist[0].Ibytes = size;
       }   
+      iomapsize = size * 2;
+      grp->statusbytes = 0;
+      if (grp->mapstatus || grp->mapmbxstatus)
+      {
+         iomapsize += ecx_config_map_status(context, pIOmap, group, LogAddr, iomapsize);
+      }
+      for (slave = 1; slave <= *(context->slavecount); slave++)
+      {
+         if (!group || (group == context->slavelist[slave].group))
+         {
+            ecx_config_finish_slave(context, group, slave);
+         }
+      }
 
-      EC_PRINT("IOmapSize %d\n", LogAddr - context->grouplist[group].logstartaddr);      
+      ecx_frameplan_build(context, group);
+      EC_PRINT("IOmapSize %d, wire bytes per cycle %d\n", iomapsize,
+               ecx_frameplan_wirebytes(context, group, NULL));      
    
-      return (LogAddr - context->grouplist[group].logstartaddr);
+      return iomapsize;
    }
    
    return 0;
-}   
+}
 
 /** Recover slave.
  *
@@ -1134,6 +1581,16 @@ int ec_config_map_group(void *pIOmap, uint8 group)
    return ecx_config_map_group(&ecx_context, pIOmap, group);
 }
 
+int ec_config_overlap_map_group(void *pIOmap, uint8 group)
+{
+   return ecx_config_overlap_map_group(&ecx_context, pIOmap, group);
+}
+
+int ec_config_segment(uint8 group, boolean balance)
+{
+   return ecx_config_segment(&ecx_context, group, balance);
+}
+
 /** Map all PDOs from slaves to IOmap.
  *
  * @param[out] pIOmap     = pointer to IOmap   
@@ -1144,6 +1601,16 @@ int ec_config_map(void *pIOmap)
    return ec_config_map_group(pIOmap, 0);
 }
 
+/** Map all PDOs from slaves to IOmap with overlapping inputs and outputs.
+ *
+ * @param[out] pIOmap     = pointer to IOmap, 2 times the logical size
+ * @return IOmap size
+ */
+int ec_config_overlap_map(void *pIOmap)
+{
+   return ec_config_overlap_map_group(pIOmap, 0);
+}
+
 /** Enumerate / map and init all slaves.
  *
  * @param[in] usetable    = TRUE when using configtable to init slaves, FALSE otherwise
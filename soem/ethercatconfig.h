@@ -58,6 +58,9 @@ extern "C"
 int ec_config_init(uint8 usetable);
 int ec_config_map(void *pIOmap);
 int ec_config_map_group(void *pIOmap, uint8 group);
+int ec_config_overlap_map(void *pIOmap);
+int ec_config_overlap_map_group(void *pIOmap, uint8 group);
+int ec_config_segment(uint8 group, boolean balance);
 int ec_config(uint8 usetable, void *pIOmap);
 int ec_recover_slave(uint16 slave, int timeout);
 int ec_reconfig_slave(uint16 slave, int timeout);
@@ -65,6 +68,8 @@ int ec_reconfig_slave(uint16 slave, int timeout);
 
 int ecx_config_init(ecx_contextt *context, uint8 usetable);
 int ecx_config_map_group(ecx_contextt *context, void *pIOmap, uint8 group);
+int ecx_config_overlap_map_group(ecx_contextt *context, void *pIOmap, uint8 group);
+int ecx_config_segment(ecx_contextt *context, uint8 group, boolean balance);
 int ecx_recover_slave(ecx_contextt *context, uint16 slave, int timeout);
 int ecx_reconfig_slave(ecx_contextt *context, uint16 slave, int timeout);
 
@@ -0,0 +1,178 @@
+/*
+ * Simple Open EtherCAT Master Library 
+ *
+ * File    : ethercatcyclic.c
+ * Version : 1.3.1
+ * Date    : 24-02-2013
+ * Copyright (C) 2005-2013 Speciaal Machinefabriek Ketels v.o.f.
+ * Copyright (C) 2005-2013 Arthur Ketels
+ * Copyright (C) 2008-2009 TU/e Technische Universiteit Eindhoven 
+ *
+ * SOEM is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License version 2 as published by the Free
+ * Software Foundation.
+ *
+ * SOEM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * for more details.
+ *
+ * As a special exception, if other files instantiate templates or use macros
+ * or inline functions from this file, or you compile this file and link it
+ * with other works to produce a work based on this file, this file does not
+ * by itself cause the resulting work to be covered by the GNU General Public
+ * License. However the source code for this file must still be made available
+ * in accordance with section (3) of the GNU General Public License.
+ *
+ * This exception does not invalidate any other reasons why a work based on
+ * this file might be covered by the GNU General Public License.
+ *
+ * The EtherCAT Technology, the trade name and logo “EtherCAT” are the intellectual
+ * property of, and protected by Beckhoff Automation GmbH. You can use SOEM for
+ * the sole purpose of creating, using and/or selling or otherwise distributing
+ * an EtherCAT network master provided that an EtherCAT Master License is obtained
+ * from Beckhoff Automation GmbH.
+ *
+ * In case you did not receive a copy of the EtherCAT Master License along with
+ * SOEM write to Beckhoff Automation GmbH, Eiserstraße 5, D-33415 Verl, Germany
+ * (www.beckhoff.com).
+ */
+
+/** \file
+ * \brief
+ * Cyclic process data executor. 
+ *
+ * Runs the send / receive of a group at a fixed period on absolute wakeup
+ * times. If the slaves have DC the wakeup is steered towards the DC sync0
+ * point with a PI controller. Missed cycles are skipped and counted,
+ * the wakeup lateness is collected in a histogram.
+ */
+#include <string.h>
+#include "oshw.h"
+#include "osal.h"
+#include "ethercattype.h"
+#include "ethercatbase.h"
+#include "ethercatmain.h"
+#include "ethercatcyclic.h"
+
+/** Initialise cyclic executor with default settings.
+ * @param[out] cyclic     = executor state
+ * @param[in]  context    = context struct
+ * @param[in]  group      = group to exchange
+ * @param[in]  cycletime  = cycle time in ns
+ */
+void ecx_cyclic_init(ec_cyclict *cyclic, ecx_contextt *context, uint8 group, int64 cycletime)
+{
+   memset(cyclic, 0, sizeof(ec_cyclict));
+   cyclic->context = context;
+   cyclic->group = group;
+   cyclic->cycletime = cycletime;
+   cyclic->syncshift = EC_CYCLICSHIFT;
+   cyclic->pdiv = EC_CYCLICPDIV;
+   cyclic->idiv = EC_CYCLICIDIV;
+   cyclic->timeout = EC_TIMEOUTRET;
+   ec_hist_init(&cyclic->latency, EC_CYCLICBINWIDTH);
+}
+
+/* PI calculation to get local wakeup time synced to DC time */
+static void ecx_cyclic_dcsync(ec_cyclict *cyclic)
+{
+   int64 delta, cycletime;
+
+   cycletime = cyclic->cycletime;
+   delta = (*(cyclic->context->DCtime) - cyclic->syncshift) % cycletime;
+   if (delta > (cycletime / 2))
+   {
+      delta -= cycletime;
+   }
+   if (delta > 0)
+   {
+      cyclic->integral++;
+   }
+   if (delta < 0)
+   {
+      cyclic->integral--;
+   }
+   cyclic->toff = -(delta / cyclic->pdiv);
+   if (cyclic->idiv)
+   {
+      cyclic->toff -= cyclic->integral / cyclic->idiv;
+   }
+   cyclic->delta = delta;
+}
+
+/** Run cyclic executor until stopped. Intended as thread function, the
+ * caller is responsible for priority and affinity of the thread.
+ * @param[in,out] cyclic  = executor state, initialised with ecx_cyclic_init()
+ */
+void ecx_cyclic_run(ec_cyclict *cyclic)
+{
+   ecx_contextt *context;
+   int64 now, late;
+
+   context = cyclic->context;
+   /* first wakeup on a whole cycle boundary */
+   now = osal_current_time_ns();
+   cyclic->wakeup = now - (now % cyclic->cycletime);
+   /* stopped before the thread came up */
+   if (cyclic->stop)
+   {
+      return;
+   }
+   ecx_send_processdata_group(context, cyclic->group);
+   while (1)
+   {
+      /* calculate next cycle start and wait for it */
+      cyclic->wakeup += cyclic->cycletime + cyclic->toff;
+      osal_sleep_until_ns(cyclic->wakeup);
+      now = osal_current_time_ns();
+      late = now - cyclic->wakeup;
+      ec_hist_add(&cyclic->latency, late);
+      if (late > cyclic->maxlate)
+      {
+         cyclic->maxlate = late;
+      }
+
+      cyclic->wkc = ecx_receive_processdata_group(context, cyclic->group, cyclic->timeout);
+      cyclic->cycles++;
+      if (cyclic->hook && !cyclic->hook(cyclic, cyclic->wkc, cyclic->hookarg))
+      {
+         cyclic->stop = 1;
+      }
+      if (cyclic->stop)
+      {
+         break;
+      }
+      if (cyclic->pdiv && context->slavelist[0].hasdc)
+      {
+         ecx_cyclic_dcsync(cyclic);
+      }
+      ecx_send_processdata_group(context, cyclic->group);
+
+      /* skip wakeups that are already in the past, keep the phase */
+      now = osal_current_time_ns();
+      while ((cyclic->wakeup + cyclic->cycletime) <= now)
+      {
+         cyclic->wakeup += cyclic->cycletime;
+         cyclic->overruns++;
+      }
+   }
+}
+
+/** Request cyclic executor to stop. The executor ends after the
+ * receive of the running cycle, no process data is left in flight.
+ * A request before the executor runs is kept, restart with
+ * ecx_cyclic_init().
+ * @param[in,out] cyclic  = executor state
+ */
+void ecx_cyclic_stop(ec_cyclict *cyclic)
+{
+   cyclic->stop = 1;
+}
+
+#ifdef EC_VER1
+void ec_cyclic_init(ec_cyclict *cyclic, uint8 group, int64 cycletime)
+{
+   ecx_cyclic_init(cyclic, &ecx_context, group, cycletime);
+}
+#endif
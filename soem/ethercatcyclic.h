@@ -0,0 +1,124 @@
+/*
+ * Simple Open EtherCAT Master Library 
+ *
+ * File    : ethercatcyclic.h
+ * Version : 1.3.1
+ * Date    : 24-02-2013
+ * Copyright (C) 2005-2013 Speciaal Machinefabriek Ketels v.o.f.
+ * Copyright (C) 2005-2013 Arthur Ketels
+ * Copyright (C) 2008-2009 TU/e Technische Universiteit Eindhoven 
+ *
+ * SOEM is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License version 2 as published by the Free
+ * Software Foundation.
+ *
+ * SOEM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * for more details.
+ *
+ * As a special exception, if other files instantiate templates or use macros
+ * or inline functions from this file, or you compile this file and link it
+ * with other works to produce a work based on this file, this file does not
+ * by itself cause the resulting work to be covered by the GNU General Public
+ * License. However the source code for this file must still be made available
+ * in accordance with section (3) of the GNU General Public License.
+ *
+ * This exception does not invalidate any other reasons why a work based on
+ * this file might be covered by the GNU General Public License.
+ *
+ * The EtherCAT Technology, the trade name and logo “EtherCAT” are the intellectual
+ * property of, and protected by Beckhoff Automation GmbH. You can use SOEM for
+ * the sole purpose of creating, using and/or selling or otherwise distributing
+ * an EtherCAT network master provided that an EtherCAT Master License is obtained
+ * from Beckhoff Automation GmbH.
+ *
+ * In case you did not receive a copy of the EtherCAT Master License along with
+ * SOEM write to Beckhoff Automation GmbH, Eiserstraße 5, D-33415 Verl, Germany
+ * (www.beckhoff.com).
+ */
+
+/** \file 
+ * \brief
+ * Headerfile for ethercatcyclic.c 
+ */
+
+#ifndef _EC_ECATCYCLIC_H
+#define _EC_ECATCYCLIC_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** default wakeup shift after the DC sync0 point in ns */
+#define EC_CYCLICSHIFT     50000
+/** default proportional divisor of the DC steering controller */
+#define EC_CYCLICPDIV      100
+/** default integral divisor of the DC steering controller */
+#define EC_CYCLICIDIV      20
+/** default bin width of the wakeup latency histogram in ns */
+#define EC_CYCLICBINWIDTH  1000
+
+typedef struct ec_cyclic ec_cyclict;
+
+/** Application hook, called every cycle between receive and send.
+ * Return 0 to stop the executor. */
+typedef int (*ec_cyclichookt)(ec_cyclict *cyclic, int wkc, void *arg);
+
+/** Absolute time cyclic executor state */
+struct ec_cyclic
+{
+   /** context the process data is exchanged on */
+   ecx_contextt   *context;
+   /** group to exchange */
+   uint8          group;
+   /** cycle time in ns */
+   int64          cycletime;
+   /** wakeup shift relative to the DC sync0 point in ns */
+   int64          syncshift;
+   /** proportional divisor of the DC steering, 0 = no DC steering */
+   int32          pdiv;
+   /** integral divisor of the DC steering, 0 = no integral part */
+   int32          idiv;
+   /** timeout in us for receive of the process data */
+   int            timeout;
+   /** application hook, can be NULL */
+   ec_cyclichookt hook;
+   /** argument passed to the application hook */
+   void           *hookarg;
+   /** set to stop the executor at the next cycle */
+   volatile int   stop;
+   /** absolute time of next wakeup in ns */
+   int64          wakeup;
+   /** current wakeup correction from the DC steering in ns */
+   int64          toff;
+   /** integral of the DC steering */
+   int64          integral;
+   /** last DC phase error in ns */
+   int64          delta;
+   /** last process data workcounter */
+   int            wkc;
+   /** number of executed cycles */
+   uint32         cycles;
+   /** number of missed cycles */
+   uint32         overruns;
+   /** largest wakeup lateness in ns */
+   int64          maxlate;
+   /** wakeup lateness histogram */
+   ec_histt       latency;
+};
+
+#ifdef EC_VER1
+void ec_cyclic_init(ec_cyclict *cyclic, uint8 group, int64 cycletime);
+#endif
+
+void ecx_cyclic_init(ec_cyclict *cyclic, ecx_contextt *context, uint8 group, int64 cycletime);
+void ecx_cyclic_run(ec_cyclict *cyclic);
+void ecx_cyclic_stop(ec_cyclict *cyclic);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _EC_ECATCYCLIC_H */
@@ -43,6 +43,7 @@
  * Distributed Clock EtherCAT functions. 
  *
  */
+#include <string.h>
 #include "oshw.h"
 #include "osal.h"
 #include "ethercattype.h"
@@ -438,10 +439,211 @@ boolean ecx_configdc(ecx_contextt *context)
          }
       }
    }
+   /* the frame plan of group 0 carries the DC datagram */
+   ecx_frameplan_build(context, 0);
 
    return context->slavelist[0].hasdc;
 }
 
+/** Check for a DC slave of a group.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ * @param[in]  slave          = slave number
+ * @return TRUE if the slave is a DC slave of the group.
+ */
+static boolean ecx_dcquality_slave(ecx_contextt *context, uint8 group, uint16 slave)
+{
+   return context->slavelist[slave].hasdc &&
+          (!group || (group == context->slavelist[slave].group));
+}
+
+/** Monitor the DC synchronization quality of the slaves of a group. With
+ * every send of the group the system time difference (ECT_REG_DCSYSDIFF)
+ * of subset DC slaves is read with a FPRD in the same frames as the
+ * process data, the next send reads the next slaves. The receive keeps
+ * last, min, max and mean per slave in the table, read them with
+ * ecx_dcquality_read(). Every read slave takes one datagram of
+ * EC_MAXIDXSTACK.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ * @param[in]  table          = quality table indexed by slave number, must
+ * stay valid until detached
+ * @param[in]  size           = number of entries in table, more than the slave count
+ * @param[in]  subset         = DC slaves read per send, limited to the DC slaves of the group
+ * @return 1 if done, 0 if the group has no DC slave, the datagrams do not
+ * fit or the group is zero copy
+ */
+int ecx_dcquality_attach(ecx_contextt *context, uint8 group, ec_dcqualt *table, uint16 size,
+                         uint16 subset)
+{
+   ec_groupt *grp;
+   uint16 slave, ndc;
+   int n;
+
+   if ((group >= context->maxgroup) || (size <= *(context->slavecount)) || !subset)
+   {
+      return 0;
+   }
+   grp = &context->grouplist[group];
+   ndc = 0;
+   for (slave = 1; slave <= *(context->slavecount); slave++)
+   {
+      if (ecx_dcquality_slave(context, group, slave))
+      {
+         ndc++;
+      }
+   }
+   if (subset > ndc)
+   {
+      subset = ndc;
+   }
+   if (!ndc || grp->zerocopy)
+   {
+      return 0;
+   }
+   /* datagrams of the group with the DC slave reads in place of any before */
+   n = ecx_groupdatagramcount(context, group) - (grp->dcqual ? grp->dcqualsubset : 0) + subset;
+   if (n > EC_MAXIDXSTACK)
+   {
+      return 0;
+   }
+   memset(table, 0, sizeof(ec_dcqualt) * size);
+   grp->dcqualsize = size;
+   grp->dcqualsubset = subset;
+   grp->dcqualnext = 0;
+   grp->dcqual = table;
+   ecx_frameplan_build(context, group);
+
+   return 1;
+}
+
+/** Stop monitoring the DC synchronization quality of a group.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ */
+void ecx_dcquality_detach(ecx_contextt *context, uint8 group)
+{
+   if (group >= context->maxgroup)
+   {
+      return;
+   }
+   context->grouplist[group].dcqual = NULL;
+   ecx_frameplan_build(context, group);
+}
+
+/** Read the DC synchronization quality of a slave, safe from any thread.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ * @param[in]  slave          = slave number
+ * @param[out] snap           = quality of the slave
+ * @return 1 if the slave has samples, 0 if not.
+ */
+int ecx_dcquality_read(ecx_contextt *context, uint8 group, uint16 slave, ec_dcqualsnapt *snap)
+{
+   ec_groupt *grp;
+   ec_dcqualt *qual;
+   uint32 seq;
+   int64 sum;
+
+   memset(snap, 0, sizeof(ec_dcqualsnapt));
+   if (group >= context->maxgroup)
+   {
+      return 0;
+   }
+   grp = &context->grouplist[group];
+   if (!grp->dcqual || (slave >= grp->dcqualsize))
+   {
+      return 0;
+   }
+   qual = &grp->dcqual[slave];
+   /* retry while the receive updates the entry */
+   do
+   {
+      seq = osal_atomic_load(&qual->seq);
+      snap->count = qual->count;
+      snap->last = qual->last;
+      snap->min = qual->min;
+      snap->max = qual->max;
+      sum = qual->sum;
+      osal_atomic_fence();
+   } while ((seq & 1) || (seq != osal_atomic_load(&qual->seq)));
+   if (!snap->count)
+   {
+      return 0;
+   }
+   snap->mean = (int32)(sum / snap->count);
+
+   return 1;
+}
+
+/** Next DC slave of a group to read, internal to the process data send.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ * @return Slave number.
+ */
+uint16 ecx_dcquality_next(ecx_contextt *context, uint8 group)
+{
+   ec_groupt *grp;
+   uint16 slave;
+   int i;
+
+   grp = &context->grouplist[group];
+   slave = grp->dcqualnext;
+   for (i = 0; i < *(context->slavecount); i++)
+   {
+      if (++slave > *(context->slavecount))
+      {
+         slave = 1;
+      }
+      if (ecx_dcquality_slave(context, group, slave) && (slave < grp->dcqualsize))
+      {
+         break;
+      }
+   }
+   grp->dcqualnext = slave;
+
+   return slave;
+}
+
+/** Add the system time difference of the last read to the statistics,
+ * internal to the process data receive. The register holds the magnitude
+ * in bit 0-30 and the sign in bit 31.
+ * @param[in]  qual           = quality table entry
+ */
+void ecx_dcquality_sample(ec_dcqualt *qual)
+{
+   uint32 raw;
+   uint16 wkc;
+   int32 diff;
+
+   memcpy(&wkc, qual->rx + sizeof(uint32), EC_WKCSIZE);
+   if (!etohs(wkc))
+   {
+      return;
+   }
+   memcpy(&raw, qual->rx, sizeof(uint32));
+   raw = etohl(raw);
+   diff = (int32)(raw & 0x7fffffff);
+   if (raw & 0x80000000)
+   {
+      diff = -diff;
+   }
+   osal_atomic_store(&qual->seq, qual->seq + 1);
+   osal_atomic_fence();
+   if (!qual->count || (diff < qual->min))
+   {
+      qual->min = diff;
+   }
+   if (!qual->count || (diff > qual->max))
+   {
+      qual->max = diff;
+   }
+   qual->last = diff;
+   qual->sum += diff;
+   qual->count++;
+   osal_atomic_store(&qual->seq, qual->seq + 1);
+}
+
 #ifdef EC_VER1
 void ec_dcsync0(uint16 slave, boolean act, uint32 CyclTime, uint32 CyclShift)
 {
@@ -457,4 +659,19 @@ boolean ec_configdc(void)
 {
    return ecx_configdc(&ecx_context);
 }
+
+int ec_dcquality_attach(uint8 group, ec_dcqualt *table, uint16 size, uint16 subset)
+{
+   return ecx_dcquality_attach(&ecx_context, group, table, size, subset);
+}
+
+void ec_dcquality_detach(uint8 group)
+{
+   ecx_dcquality_detach(&ecx_context, group);
+}
+
+int ec_dcquality_read(uint8 group, uint16 slave, ec_dcqualsnapt *snap)
+{
+   return ecx_dcquality_read(&ecx_context, group, slave, snap);
+}
 #endif
@@ -51,15 +51,61 @@ extern "C"
 {
 #endif
 
+/** DC synchronization quality of one slave, see ecx_dcquality_attach().
+ * Written by the thread cycling the group, read with ecx_dcquality_read()
+ * from any thread. */
+typedef struct ec_dcqual
+{
+   /** internal, response of the last read, system time difference and
+    * work counter, must be the first member */
+   uint8           rx[sizeof(uint32) + EC_WKCSIZE];
+   /** internal, odd while the statistics are updated */
+   volatile uint32 seq;
+   /** number of samples */
+   uint32          count;
+   /** last system time difference in ns */
+   int32           last;
+   /** smallest system time difference in ns */
+   int32           min;
+   /** largest system time difference in ns */
+   int32           max;
+   /** sum of all samples */
+   int64           sum;
+} ec_dcqualt;
+
+/** Copy of the DC synchronization quality of one slave */
+typedef struct
+{
+   /** number of samples */
+   uint32          count;
+   /** last system time difference in ns */
+   int32           last;
+   /** smallest system time difference in ns */
+   int32           min;
+   /** largest system time difference in ns */
+   int32           max;
+   /** mean system time difference in ns */
+   int32           mean;
+} ec_dcqualsnapt;
+
 #ifdef EC_VER1
 boolean ec_configdc();
 void ec_dcsync0(uint16 slave, boolean act, uint32 CyclTime, uint32 CyclShift);
 void ec_dcsync01(uint16 slave, boolean act, uint32 CyclTime0, uint32 CyclTime1, uint32 CyclShift);
+int ec_dcquality_attach(uint8 group, ec_dcqualt *table, uint16 size, uint16 subset);
+void ec_dcquality_detach(uint8 group);
+int ec_dcquality_read(uint8 group, uint16 slave, ec_dcqualsnapt *snap);
 #endif
 
 boolean ecx_configdc(ecx_contextt *context);
 void ecx_dcsync0(ecx_contextt *context, uint16 slave, boolean act, uint32 CyclTime, uint32 CyclShift);
 void ecx_dcsync01(ecx_contextt *context, uint16 slave, boolean act, uint32 CyclTime0, uint32 CyclTime1, uint32 CyclShift);
+int ecx_dcquality_attach(ecx_contextt *context, uint8 group, ec_dcqualt *table, uint16 size,
+                         uint16 subset);
+void ecx_dcquality_detach(ecx_contextt *context, uint8 group);
+int ecx_dcquality_read(ecx_contextt *context, uint8 group, uint16 slave, ec_dcqualsnapt *snap);
+uint16 ecx_dcquality_next(ecx_contextt *context, uint8 group);
+void ecx_dcquality_sample(ec_dcqualt *qual);
 
 #ifdef __cplusplus
 }
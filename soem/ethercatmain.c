@@ -57,11 +57,26 @@
 #include "ethercattype.h"
 #include "ethercatbase.h"
 #include "ethercatmain.h"
+#include "ethercatpimage.h"
+#include "ethercattiming.h"
+#include "ethercatdc.h"
 
 
 /** delay in us for eeprom ready loop */
 #define EC_LOCALDELAY  200
 
+/** state check poll interval of context in us */
+#define EC_STATEPOLL(context) \
+   ((context)->statepolldelay ? (context)->statepolldelay : EC_STATEPOLLDELAY)
+/** mailbox status poll interval of context in us */
+#define EC_MBXPOLL(context) \
+   ((context)->mbxpolldelay ? (context)->mbxpolldelay : EC_MBXPOLLDELAY)
+
+/** min. Ethernet frame size without FCS */
+#define EC_MINETHFRAME  60
+/** Ethernet FCS, preamble and inter frame gap per frame */
+#define EC_ETHOVERHEAD  (4 + 8 + 12)
+
 /** record for ethercat eeprom communications */       
 PACKED_BEGIN
 typedef struct PACKED
@@ -94,6 +109,23 @@ typedef struct PACKED
    uint16          w1,w2;
 } ec_emcyt;
 PACKED_END
+
+/** maximum length of a frame without FCS */
+#define EC_MAXFRAMELENGTH  (ETH_HEADERSIZE + EC_HEADERSIZE + EC_MAXLRWDATA + EC_WKCSIZE)
+
+/** alignment of the blocks in a context arena */
+#define EC_ARENAALIGN  64
+
+/** context arena, the context is the first member so the arena can
+ * be found back from the context pointer */
+typedef struct
+{
+   ecx_contextt   context;
+   /** size of the arena as allocated */
+   size_t         size;
+   /** osal arena flags used for allocation */
+   int            flags;
+} ecx_contextarenat;
    
 #ifdef EC_VER1
 /** Main slave data array.
@@ -113,7 +145,7 @@ static uint8            esibuf[EC_MAXEEPBUF];
 static uint32           esimap[EC_MAXEEPBITMAP];
 /** current slave for EEPROM cache buffer */
 static ec_eringt        ec_elist;
-static ec_idxstackT     ec_idxstack;
+static ec_idxstackT     ec_idxstack[EC_MAXGROUP];
 
 /** SyncManager Communication Type struct to store data of one slave */
 static ec_SMcommtypet   ec_SMcommtype;
@@ -126,6 +158,8 @@ static ec_PDOdesct      ec_PDOdesc;
 static ec_eepromSMt     ec_SM;
 /** buffer for EEPROM FMMU data */
 static ec_eepromFMMUt   ec_FMMU;
+/** PDO entry table of all slaves */
+static ec_pdoentryt     ec_pdoentry[EC_MAXPDOENTRY];
 /** Global variable TRUE if error available in error stack */
 boolean                 EcatError = FALSE;
 
@@ -145,16 +179,22 @@ ecx_contextt  ecx_context = {
     &esimap[0],      // .esimap        =
     0,               // .esislave      =
     &ec_elist,       // .elist         =
-    &ec_idxstack,    // .idxstack      =
+    &ec_idxstack[0], // .idxstack      =
     &EcatError,      // .ecaterror     =
-    0,               // .DCtO          =
-    0,               // .DCl           =
     &ec_DCtime,      // .DCtime        =
     &ec_SMcommtype,  // .SMcommtype    =
     &ec_PDOassign,   // .PDOassign     =
     &ec_PDOdesc,     // .PDOdesc       =
     &ec_SM,          // .eepSM         =
-    &ec_FMMU         // .eepFMMU       =
+    &ec_FMMU,        // .eepFMMU       =
+    NULL,            // .FOEhook       =
+    0,               // .statepolldelay =
+    0,               // .mbxpolldelay  =
+    &ec_pdoentry[0], // .pdoentry      =
+    EC_MAXPDOENTRY,  // .maxpdoentry   =
+    0,               // .npdoentry     =
+    0,               // .pdoslave      =
+    NULL             // .acyclicq      =
 };  
 #endif
     
@@ -311,6 +351,132 @@ static void ecx_mbxemergencyerror(ecx_contextt *context, uint16 Slave,uint16 Err
    ecx_pusherror(context, &Ec);
 }
 
+/* Lay out all context blocks in the arena. With base NULL only the size
+ * is calculated, otherwise the context pointers are set. */
+static size_t ecx_context_layout(const ecx_contextparamt *params, uint8 *base)
+{
+   ecx_contextarenat *arena;
+   ecx_contextt *context;
+   ecx_redportt *redport;
+   size_t offset;
+
+#define EC_ARENATAKE(ptr, type, n)                                            \
+   do {                                                                       \
+      offset = (offset + EC_ARENAALIGN - 1) & ~(size_t)(EC_ARENAALIGN - 1);   \
+      if (base) (ptr) = (type *)(base + offset);                              \
+      offset += sizeof(type) * (n);                                           \
+   } while (0)
+
+   offset = 0;
+   arena = NULL;
+   context = NULL;
+   redport = NULL;
+   EC_ARENATAKE(arena, ecx_contextarenat, 1);
+   if (base)
+   {
+      context = &arena->context;
+   }
+   EC_ARENATAKE(context->port, ecx_portt, 1);
+   if (params->redundant)
+   {
+      EC_ARENATAKE(redport, ecx_redportt, 1);
+   }
+   EC_ARENATAKE(context->slavelist, ec_slavet, params->maxslave);
+   EC_ARENATAKE(context->slavecount, int, 1);
+   EC_ARENATAKE(context->grouplist, ec_groupt, params->maxgroup);
+   EC_ARENATAKE(context->esibuf, uint8, EC_MAXEEPBUF);
+   EC_ARENATAKE(context->esimap, uint32, EC_MAXEEPBITMAP);
+   EC_ARENATAKE(context->elist, ec_eringt, 1);
+   EC_ARENATAKE(context->idxstack, ec_idxstackT, params->maxgroup);
+   EC_ARENATAKE(context->ecaterror, boolean, 1);
+   EC_ARENATAKE(context->DCtime, int64, 1);
+   EC_ARENATAKE(context->SMcommtype, ec_SMcommtypet, 1);
+   EC_ARENATAKE(context->PDOassign, ec_PDOassignt, 1);
+   EC_ARENATAKE(context->PDOdesc, ec_PDOdesct, 1);
+   EC_ARENATAKE(context->eepSM, ec_eepromSMt, 1);
+   EC_ARENATAKE(context->eepFMMU, ec_eepromFMMUt, 1);
+   EC_ARENATAKE(context->pdoentry, ec_pdoentryt, params->maxpdoentry);
+#undef EC_ARENATAKE
+
+   if (base)
+   {
+      context->maxslave = params->maxslave;
+      context->maxgroup = params->maxgroup;
+      context->maxpdoentry = params->maxpdoentry;
+      context->port->redport = redport;
+   }
+   return offset;
+}
+
+/** Create context with all its buffers in one memory arena. The slave and
+ * group lists are sized as requested instead of the compile time maxima.
+ * If requested the arena is placed in huge pages and prefaulted so the
+ * cyclic part does not take page faults.
+ * @param[in]  params   = creation parameters, NULL for defaults
+ * @return new context or NULL if no memory available
+ */
+ecx_contextt *ecx_context_create(const ecx_contextparamt *params)
+{
+   ecx_contextparamt p;
+   ecx_contextarenat *arena;
+   size_t size;
+   int flags;
+
+   memset(&p, 0, sizeof(p));
+   if (params)
+   {
+      p = *params;
+   }
+   if (p.maxslave <= 1)
+   {
+      p.maxslave = EC_MAXSLAVE;
+   }
+   if (p.maxgroup <= 0)
+   {
+      p.maxgroup = EC_MAXGROUP;
+   }
+   if (p.maxpdoentry <= 0)
+   {
+      p.maxpdoentry = EC_MAXPDOENTRY;
+   }
+   flags = 0;
+   if (p.hugepages)
+   {
+      flags |= OSAL_ARENA_HUGEPAGE;
+   }
+   if (p.prefault)
+   {
+      flags |= OSAL_ARENA_PREFAULT;
+   }
+   size = ecx_context_layout(&p, NULL);
+   /* flags tell afterwards how the arena is mapped, needed to free it */
+   arena = osal_arena_alloc(size, &flags);
+   if (arena == NULL)
+   {
+      return NULL;
+   }
+   ecx_context_layout(&p, (uint8 *)arena);
+   arena->size = size;
+   arena->flags = flags;
+
+   return &arena->context;
+}
+
+/** Destroy context made by ecx_context_create(). The NIC must be closed
+ * with ecx_close() before.
+ * @param[in]  context  = context struct
+ */
+void ecx_context_destroy(ecx_contextt *context)
+{
+   ecx_contextarenat *arena;
+
+   if (context)
+   {
+      arena = (ecx_contextarenat *)context;
+      osal_arena_free(arena, arena->size, arena->flags);
+   }
+}
+
 /** Initialise lib in single NIC mode
  * @param[in]  context        = context struct
  * @param[in] ifname   = Dev name, f.e. "eth0"
@@ -642,7 +808,8 @@ uint16 ecx_siiSMnext(ecx_contextt *context, uint16 slave, ec_eepromSMt* SM, uint
  */
 int ecx_siiPDO(ecx_contextt *context, uint16 slave, ec_eepromPDOt* PDO, uint8 t)
 {
-   uint16 a , w, c, e, er, Size;
+   uint16 a , w, c, e, er, Size, eindex;
+   uint8 esub, ename, etype, ebits, sm;
    uint8 eectl = context->slavelist[slave].eep_pdi;
 
    Size = 0;
@@ -674,13 +841,21 @@ int ecx_siiPDO(ecx_contextt *context, uint16 slave, ec_eepromPDOt* PDO, uint8 t)
          c += 2;
          if (PDO->SyncM[PDO->nPDO] < EC_MAXSM) /* active and in range SM? */
          {
+            sm = (uint8)PDO->SyncM[PDO->nPDO];
             /* read all entries defined in PDO */
             for (er = 1; er <= e; er++)
             {
                c += 4;
-               a += 5;
-               PDO->BitSize[PDO->nPDO] += ecx_siigetbyte(context, slave, a++);
+               eindex = ecx_siigetbyte(context, slave, a++);
+               eindex += (ecx_siigetbyte(context, slave, a++) << 8);
+               esub = ecx_siigetbyte(context, slave, a++);
+               ename = ecx_siigetbyte(context, slave, a++);
+               etype = ecx_siigetbyte(context, slave, a++);
+               ebits = ecx_siigetbyte(context, slave, a++);
                a += 2;
+               ecx_pdo_add(context, slave, sm, eindex, esub, ebits,
+                           PDO->SMbitsize[sm] + PDO->BitSize[PDO->nPDO], etype, ename);
+               PDO->BitSize[PDO->nPDO] += ebits;
             }
             PDO->SMbitsize[ PDO->SyncM[PDO->nPDO] ] += PDO->BitSize[PDO->nPDO];
             Size += PDO->BitSize[PDO->nPDO];
@@ -707,6 +882,233 @@ int ecx_siiPDO(ecx_contextt *context, uint16 slave, ec_eepromPDOt* PDO, uint8 t)
    return (Size);
 }
 
+/** Start recording the PDO entries of a slave. Entries read from the CoE
+ * PDO mapping or the SII PDO categories are added to the PDO entry table
+ * until ecx_pdo_end(). Earlier entries of the slave are removed from the
+ * table, so remapping a group does not fill up the table.
+ * @param[in]  context        = context struct
+ * @param[in]  slave          = slave number
+ */
+void ecx_pdo_begin(ecx_contextt *context, uint16 slave)
+{
+   ec_slavet *sl;
+   uint16 first, n, i;
+
+   sl = &context->slavelist[slave];
+   if (sl->npdoentry)
+   {
+      /* close the gap, the entries of later slaves move down */
+      first = sl->pdoentry;
+      n = sl->npdoentry;
+      memmove(&context->pdoentry[first], &context->pdoentry[first + n],
+              sizeof(ec_pdoentryt) * (context->npdoentry - first - n));
+      context->npdoentry -= n;
+      for (i = 1; i <= *(context->slavecount); i++)
+      {
+         if (context->slavelist[i].npdoentry && (context->slavelist[i].pdoentry > first))
+         {
+            context->slavelist[i].pdoentry -= n;
+         }
+      }
+   }
+   sl->pdoentry = (uint16)context->npdoentry;
+   sl->npdoentry = 0;
+   context->pdoslave = slave;
+}
+
+/** Add a PDO entry of the slave being recorded, see ecx_pdo_begin().
+ * Ignored for other slaves or when the table is full.
+ * @param[in]  context        = context struct
+ * @param[in]  slave          = slave number
+ * @param[in]  sm             = SyncManager the entry is mapped by
+ * @param[in]  index          = object index, 0 for a gap
+ * @param[in]  subindex       = object subindex
+ * @param[in]  bitlen         = bit length
+ * @param[in]  bitoffset      = bit offset in the SyncManager
+ * @param[in]  datatype       = data type, 0 if unknown
+ * @param[in]  name           = SII string number of the name, 0 if unknown
+ */
+void ecx_pdo_add(ecx_contextt *context, uint16 slave, uint8 sm, uint16 index, uint8 subindex,
+                 uint16 bitlen, uint32 bitoffset, uint16 datatype, uint8 name)
+{
+   ec_pdoentryt *entry;
+
+   if (!slave || (slave != context->pdoslave) || (context->npdoentry >= context->maxpdoentry))
+   {
+      return;
+   }
+   entry = &context->pdoentry[context->npdoentry++];
+   entry->index = index;
+   entry->subindex = subindex;
+   entry->sm = sm;
+   entry->datatype = datatype;
+   entry->bitlen = bitlen;
+   entry->bitoffset = bitoffset;
+   entry->name = name;
+   entry->output = FALSE;
+   context->slavelist[slave].npdoentry++;
+}
+
+/** Finish recording the PDO entries of a slave. The SyncManager types and
+ * lengths must be known, the bit offsets are made relative to the start of
+ * the slave inputs or outputs, as mapped in the IOmap. The CoE mapping has
+ * no data types, these are derived from the bit length as unsigned.
+ * @param[in]  context        = context struct
+ * @param[in]  slave          = slave number
+ */
+void ecx_pdo_end(ecx_contextt *context, uint16 slave)
+{
+   ec_slavet *sl;
+   ec_pdoentryt *entry;
+   uint32 base;
+   uint16 n;
+   uint8 sm, type;
+
+   sl = &context->slavelist[slave];
+   for (n = 0; n < sl->npdoentry; n++)
+   {
+      entry = &context->pdoentry[sl->pdoentry + n];
+      type = (entry->sm < EC_MAXSM) ? sl->SMtype[entry->sm] : 0;
+      /* SyncManagers of the same type are mapped one after the other */
+      base = 0;
+      for (sm = 0; sm < entry->sm; sm++)
+      {
+         if (sl->SMtype[sm] == type)
+         {
+            base += etohs(sl->SM[sm].SMlength) * 8;
+         }
+      }
+      entry->bitoffset += base;
+      entry->output = (type == 3);
+      if (!entry->datatype && entry->index)
+      {
+         switch (entry->bitlen)
+         {
+            case 1:
+               entry->datatype = ECT_BOOLEAN;
+               break;
+            case 8:
+               entry->datatype = ECT_UNSIGNED8;
+               break;
+            case 16:
+               entry->datatype = ECT_UNSIGNED16;
+               break;
+            case 32:
+               entry->datatype = ECT_UNSIGNED32;
+               break;
+            case 64:
+               entry->datatype = ECT_UNSIGNED64;
+               break;
+            default:
+               break;
+         }
+      }
+   }
+   context->pdoslave = 0;
+}
+
+/** Get a PDO entry of a slave.
+ * @param[in]  context        = context struct
+ * @param[in]  slave          = slave number
+ * @param[in]  n              = entry number, 0 .. npdoentry - 1
+ * @return pointer to entry or NULL if not available
+ */
+const ec_pdoentryt *ecx_pdo_entry(ecx_contextt *context, uint16 slave, uint16 n)
+{
+   ec_slavet *sl;
+
+   if ((slave < 1) || (slave > *(context->slavecount)))
+   {
+      return NULL;
+   }
+   sl = &context->slavelist[slave];
+   if (n >= sl->npdoentry)
+   {
+      return NULL;
+   }
+
+   return &context->pdoentry[sl->pdoentry + n];
+}
+
+/* resolve a PDO entry to its location in the IOmap */
+static int ecx_pdo_resolve(ecx_contextt *context, uint16 slave, const ec_pdoentryt *entry,
+                           ec_pdovart *var)
+{
+   ec_slavet *sl;
+   uint8 *data;
+   uint32 bit;
+
+   sl = &context->slavelist[slave];
+   data = entry->output ? sl->outputs : sl->inputs;
+   if (!data)
+   {
+      return 0;
+   }
+   bit = (entry->output ? sl->Ostartbit : sl->Istartbit) + entry->bitoffset;
+   var->data = data + (bit >> 3);
+   var->bit = (uint8)(bit & 7);
+   var->bitlen = entry->bitlen;
+   var->datatype = entry->datatype;
+
+   return 1;
+}
+
+/** Find a process variable of a slave by object index and subindex. The
+ * result points directly into the IOmap, resolve once after the IOmap is
+ * configured and access the variable in the cycle without lookup.
+ * @param[in]  context        = context struct
+ * @param[in]  slave          = slave number
+ * @param[in]  index          = object index
+ * @param[in]  subindex       = object subindex
+ * @param[out] var            = resolved variable
+ * @return 1 if found, 0 if not
+ */
+int ecx_pdo_find(ecx_contextt *context, uint16 slave, uint16 index, uint8 subindex,
+                 ec_pdovart *var)
+{
+   const ec_pdoentryt *entry;
+   uint16 n = 0;
+
+   while ((entry = ecx_pdo_entry(context, slave, n++)) != NULL)
+   {
+      if (entry->index && (entry->index == index) && (entry->subindex == subindex))
+      {
+         return ecx_pdo_resolve(context, slave, entry, var);
+      }
+   }
+
+   return 0;
+}
+
+/** Find a process variable of a slave by name, see ecx_pdo_find(). Names
+ * are known for entries read from the SII PDO categories.
+ * @param[in]  context        = context struct
+ * @param[in]  slave          = slave number
+ * @param[in]  name           = entry name
+ * @param[out] var            = resolved variable
+ * @return 1 if found, 0 if not
+ */
+int ecx_pdo_findname(ecx_contextt *context, uint16 slave, const char *name, ec_pdovart *var)
+{
+   const ec_pdoentryt *entry;
+   char str[EC_MAXNAME + 1];
+   uint16 n = 0;
+
+   while ((entry = ecx_pdo_entry(context, slave, n++)) != NULL)
+   {
+      if (entry->name)
+      {
+         ecx_siistring(context, str, slave, entry->name);
+         if (!strcmp(str, name))
+         {
+            return ecx_pdo_resolve(context, slave, entry, var);
+         }
+      }
+   }
+
+   return 0;
+}
+
 /** Read all slave states in ec_slave.
  * @param[in]  context        = context struct
  * @return lowest state found
@@ -801,7 +1203,7 @@ uint16 ecx_statecheck(ecx_contextt *context, uint16 slave, uint16 reqstate, int
       state = rval & 0x000f; /* read slave status */
       if (state != reqstate)
       {
-         osal_usleep(1000);
+         osal_usleep(EC_STATEPOLL(context));
       }
    }
    while ((state != reqstate) && (osal_timer_is_expired(&timer) == FALSE));
@@ -853,9 +1255,9 @@ int ecx_mbxempty(ecx_contextt *context, uint16 slave, int timeout)
    {
       wkc = ecx_FPRD(context->port, configadr, ECT_REG_SM0STAT, sizeof(SMstat), &SMstat, EC_TIMEOUTRET);
       SMstat = etohs(SMstat);
-      if (((SMstat & 0x08) != 0) && (timeout > EC_LOCALDELAY))
+      if (((SMstat & 0x08) != 0) && (timeout > (int)EC_MBXPOLL(context)))
       {
-         osal_usleep(EC_LOCALDELAY);
+         osal_usleep(EC_MBXPOLL(context));
       }
    }
    while (((wkc <= 0) || ((SMstat & 0x08) != 0)) && (osal_timer_is_expired(&timer) == FALSE));
@@ -900,8 +1302,64 @@ int ecx_mbxsend(ecx_contextt *context, uint16 slave,ec_mbxbuft *mbx, int timeout
    return wkc;
 }
 
+/** Wait for the read mailbox of a slave to fill, using the SM1 status that
+ * the process data cycle reads into the IOmap, see ec_groupt mapmbxstatus.
+ * The mapped status is checked every mailbox poll interval without sending
+ * a frame. Only a status read that was sent after the wait began and was
+ * answered is trusted, an older one may show the mailbox full from before
+ * the previous mailbox read. Only when the group has not been cycled for
+ * EC_TIMEOUTRET3 the status is read with a FPRD.
+ * @param[in]  context        = context struct
+ * @param[in]  slave          = Slave number
+ * @param[in]  timer          = timer of the mailbox receive
+ * @return TRUE if the read mailbox is full, FALSE on timeout.
+ */
+static boolean ecx_mbxwaitmapped(ecx_contextt *context, uint16 slave, osal_timert *timer)
+{
+   ec_slavet *sl;
+   ec_groupt *grp;
+   osal_timert stall;
+   uint32 sent, done;
+   uint16 SMstat;
+
+   sl = &context->slavelist[slave];
+   grp = &context->grouplist[sl->group];
+   sent = osal_atomic_load(&grp->statussent);
+   done = osal_atomic_load(&grp->statusdone);
+   osal_timer_start(&stall, EC_TIMEOUTRET3);
+   do
+   {
+      if (osal_atomic_load(&grp->statusdone) != done)
+      {
+         /* status refreshed by a receive of the group */
+         done = osal_atomic_load(&grp->statusdone);
+         if (((int32)(done - sent) > 0) && (grp->statuswkc > 0) &&
+             (*(sl->mbxstatus) & 0x08))
+         {
+            return TRUE;
+         }
+         osal_timer_start(&stall, EC_TIMEOUTRET3);
+      }
+      else if (osal_timer_is_expired(&stall))
+      {
+         /* process data not cycled */
+         if ((ecx_FPRD(context->port, sl->configadr, ECT_REG_SM1STAT, sizeof(SMstat), &SMstat,
+                       EC_TIMEOUTRET) > 0) && (etohs(SMstat) & 0x08))
+         {
+            return TRUE;
+         }
+         osal_timer_start(&stall, EC_TIMEOUTRET3);
+      }
+      osal_usleep(EC_MBXPOLL(context));
+   } while (!osal_timer_is_expired(timer));
+
+   return FALSE;
+}
+
 /** Read OUT mailbox from slave.
- * Supports Mailbox Link Layer with repeat requests.
+ * Supports Mailbox Link Layer with repeat requests. When the SM1 status is
+ * mapped and read with the process data, see ecx_statusmap_cyclic(), no
+ * frames are spent on polling the mailbox status.
  * @param[in]  context        = context struct
  * @param[in]  slave      = Slave number
  * @param[out] mbx        = Mailbox data
@@ -918,6 +1376,7 @@ int ecx_mbxreceive(ecx_contextt *context, uint16 slave, ec_mbxbuft *mbx, int tim
    ec_mbxheadert *mbxh;
    ec_emcyt *EMp;
    ec_mbxerrort *MBXEp;
+   boolean mapped;
 
    configadr = context->slavelist[slave].configadr;
    mbxl = context->slavelist[slave].mbx_rl;
@@ -927,16 +1386,27 @@ int ecx_mbxreceive(ecx_contextt *context, uint16 slave, ec_mbxbuft *mbx, int tim
 
       osal_timer_start(&timer, timeout);
       wkc = 0;
-      do /* wait for read mailbox available */
+      mapped = context->slavelist[slave].mbxstatus &&
+               context->grouplist[context->slavelist[slave].group].cyclicstatus;
+      if (mapped)
+      {
+         /* only the full flag is known, the repeat bit is read when needed */
+         wkc = ecx_mbxwaitmapped(context, slave, &timer) ? 1 : 0;
+         SMstat = wkc ? 0x08 : 0;
+      }
+      else
       {
-         wkc = ecx_FPRD(context->port, configadr, ECT_REG_SM1STAT, sizeof(SMstat), &SMstat, EC_TIMEOUTRET);
-         SMstat = etohs(SMstat);
-         if (((SMstat & 0x08) == 0) && (timeout > EC_LOCALDELAY))
+         do /* wait for read mailbox available */
          {
-            osal_usleep(EC_LOCALDELAY);
+            wkc = ecx_FPRD(context->port, configadr, ECT_REG_SM1STAT, sizeof(SMstat), &SMstat, EC_TIMEOUTRET);
+            SMstat = etohs(SMstat);
+            if (((SMstat & 0x08) == 0) && (timeout > (int)EC_MBXPOLL(context)))
+            {
+               osal_usleep(EC_MBXPOLL(context));
+            }
          }
+         while (((wkc <= 0) || ((SMstat & 0x08) == 0)) && (osal_timer_is_expired(&timer) == FALSE));
       }
-      while (((wkc <= 0) || ((SMstat & 0x08) == 0)) && (osal_timer_is_expired(&timer) == FALSE));
 
       if ((wkc > 0) && ((SMstat & 0x08) > 0)) /* read mailbox available ? */
       {
@@ -965,6 +1435,11 @@ int ecx_mbxreceive(ecx_contextt *context, uint16 slave, ec_mbxbuft *mbx, int tim
             {
                if (wkc <= 0) /* read mailbox lost */
                {
+                  if (mapped)
+                  {
+                     ecx_FPRD(context->port, configadr, ECT_REG_SM1STAT, sizeof(SMstat), &SMstat, EC_TIMEOUTRET);
+                     SMstat = etohs(SMstat);
+                  }
                   SMstat ^= 0x0200; /* toggle repeat request */
                   SMstat = htoes(SMstat);
                   wkc2 = ecx_FPWR(context->port, configadr, ECT_REG_SM1STAT, sizeof(SMstat), &SMstat, EC_TIMEOUTRET);
@@ -977,14 +1452,19 @@ int ecx_mbxreceive(ecx_contextt *context, uint16 slave, ec_mbxbuft *mbx, int tim
                   {
                      wkc2 = ecx_FPRD(context->port, configadr, ECT_REG_SM1STAT, sizeof(SMstat), &SMstat, EC_TIMEOUTRET);
                      SMstat = etohs(SMstat);
-                     if (((SMstat & 0x08) == 0) && (timeout > EC_LOCALDELAY))
+                     if (((SMstat & 0x08) == 0) && (timeout > (int)EC_MBXPOLL(context)))
                      {
-                        osal_usleep(EC_LOCALDELAY);
+                        osal_usleep(EC_MBXPOLL(context));
                      }
                   } while (((wkc2 <= 0) || ((SMstat & 0x08) == 0)) && (osal_timer_is_expired(&timer) == FALSE));
                }
             }
          } while ((wkc <= 0) && (osal_timer_is_expired(&timer) == FALSE)); /* if WKC<=0 repeat */
+         if (mapped)
+         {
+            /* the mailbox is empty now, until the next status read */
+            *(context->slavelist[slave].mbxstatus) &= (uint8)~0x08;
+         }
       }
       else /* no read mailbox available */
       {
@@ -1524,278 +2004,2080 @@ uint32 ecx_readeeprom2(ecx_contextt *context, uint16 slave, int timeout)
 }
 
 /** Push index of segmented LRD/LWR/LRW combination.
- * @param[in]  context        = context struct
+ * @param[in]  idxstack       = index stack of group
  * @param[in] idx         = Used datagram index.
  * @param[in] data        = Pointer to process data segment.
  * @param[in] length      = Length of data segment in bytes.
+ * @param[in] cmd         = Datagram command.
+ * @param[in] rxoffset    = Offset of datagram data in rx frame.
+ * @param[in] group       = Group the datagram belongs to.
  */
-static void ecx_pushindex(ecx_contextt *context, uint8 idx, void *data, uint16 length)
+static void ecx_pushindex(ec_idxstackT *idxstack, uint8 idx, void *data, uint16 length,
+                          uint8 cmd, uint16 rxoffset, uint8 group)
 {
-   if(context->idxstack->pushed < EC_MAXBUF)
+   if(idxstack->pushed < EC_MAXIDXSTACK)
    {
-      context->idxstack->idx[context->idxstack->pushed] = idx;
-      context->idxstack->data[context->idxstack->pushed] = data;
-      context->idxstack->length[context->idxstack->pushed] = length;
-      context->idxstack->pushed++;
+      idxstack->idx[idxstack->pushed] = idx;
+      idxstack->data[idxstack->pushed] = data;
+      idxstack->length[idxstack->pushed] = length;
+      idxstack->cmd[idxstack->pushed] = cmd;
+      idxstack->rxoffset[idxstack->pushed] = rxoffset;
+      idxstack->group[idxstack->pushed] = group;
+      idxstack->acyclic[idxstack->pushed] = NULL;
+      idxstack->pushed++;
    }
 }
 
-/** Pull index of segmented LRD/LWR/LRW combination.
- * @param[in]  context        = context struct
- * @return Stack location, -1 if stack is empty.
+/** Add datagram to the list of datagrams to pack in frames.
+ * @param[in,out] dg      = datagram list
+ * @param[in,out] n       = number of datagrams in list
+ * @param[in] cmd         = datagram command
+ * @param[in] ADP         = address position / logical address low word
+ * @param[in] ADO         = address offset / logical address high word
+ * @param[in] length      = data length
+ * @param[in] data        = process data pointer
+ * @param[in] rxdata      = process data pointer the response is copied to
+ * @param[in] rxskip      = bytes at the start of the response not copied back
+ * @param[in] group       = group the datagram belongs to
  */
-static int ecx_pullindex(ecx_contextt *context)
+static void ecx_adddg(ec_pdatagramt *dg, int *n, uint8 cmd, uint16 ADP, uint16 ADO,
+                      uint16 length, void *data, void *rxdata, uint16 rxskip, uint8 group)
 {
-   int rval = -1;
-   if(context->idxstack->pulled < context->idxstack->pushed)
+   if (*n < EC_MAXIDXSTACK)
    {
-      rval = context->idxstack->pulled;
-      context->idxstack->pulled++;
+      dg[*n].cmd = cmd;
+      dg[*n].ADP = ADP;
+      dg[*n].ADO = ADO;
+      dg[*n].length = length;
+      dg[*n].data = data;
+      dg[*n].rxdata = rxdata;
+      dg[*n].rxskip = rxskip;
+      dg[*n].group = group;
+      (*n)++;
    }
+}
 
-   return rval;
+/** Check for a logical process data command.
+ * @param[in] cmd         = datagram command
+ * @return TRUE for LRD, LWR and LRW.
+ */
+static boolean ecx_islogical(uint8 cmd)
+{
+   return (cmd == EC_CMD_LRD) || (cmd == EC_CMD_LWR) || (cmd == EC_CMD_LRW);
 }
 
-/** Transmit processdata to slaves.
- * Uses LRW, or LRD/LWR if LRW is not allowed (blockLRW).
- * Both the input and output processdata are transmitted.
- * The outputs with the actual data, the inputs have a placeholder.
- * The inputs are gathered with the receive processdata function.
- * In contrast to the base LRW function this function is non-blocking.
- * If the processdata does not fit in one datagram, multiple are used.
- * In order to recombine the slave response, a stack is used.
+/** Lay out datagrams in as few frames as possible. Datagrams are kept in
+ * order, a new frame is started when the next datagram does not fit
+ * anymore. Sets the offset in the frame and the more flag of every datagram,
+ * and numbers the process data datagrams of each group.
+ * @param[in,out] dg          = datagram list
+ * @param[in]  n              = number of datagrams in list
+ */
+static void ecx_layoutdatagrams(ec_pdatagramt *dg, int n)
+{
+   int i, size = 0, seq = 0, group = -1;
+
+   for (i = 0; i < n; i++)
+   {
+      /* the process data datagrams of a group are added together */
+      dg[i].seq = 0;
+      if (ecx_islogical(dg[i].cmd))
+      {
+         if (dg[i].group != group)
+         {
+            group = dg[i].group;
+            seq = 0;
+         }
+         dg[i].seq = (uint8)seq++;
+      }
+      dg[i].more = FALSE;
+      if (i && ((size + EC_HEADERSIZE - EC_ELENGTHSIZE + dg[i].length + EC_WKCSIZE) <= EC_MAXFRAMELENGTH))
+      {
+         /* append to the frame of the previous datagram */
+         dg[i - 1].more = TRUE;
+         dg[i].rxoffset = (uint16)(size - ETH_HEADERSIZE + EC_HEADERSIZE - EC_ELENGTHSIZE);
+         size += EC_HEADERSIZE - EC_ELENGTHSIZE + dg[i].length + EC_WKCSIZE;
+      }
+      else
+      {
+         dg[i].rxoffset = EC_HEADERSIZE;
+         size = ETH_HEADERSIZE + EC_HEADERSIZE + dg[i].length + EC_WKCSIZE;
+      }
+   }
+}
+
+/** Transmit laid out datagrams, see ecx_layoutdatagrams(). Every datagram
+ * is pushed on the index stack with its frame index and offset in the
+ * frame, a skipped part of the response is left out of the stack entry.
+ * @param[in]  context        = context struct
+ * @param[in]  idxstack       = index stack of group
+ * @param[in]  dg             = datagram list
+ * @param[in]  n              = number of datagrams in list
+ */
+static void ecx_senddatagrams(ecx_contextt *context, ec_idxstackT *idxstack,
+                              const ec_pdatagramt *dg, int n)
+{
+   int i;
+   uint8 idx = 0;
+   uint8 *data;
+   ec_groupt *grp;
+
+   for (i = 0; i < n; i++)
+   {
+      data = dg[i].data;
+      grp = &context->grouplist[dg[i].group];
+      /* after communication loss the safe outputs are sent instead */
+      if (grp->safeactive && (data >= grp->outputs) && (data < (grp->outputs + grp->Obytes)))
+      {
+         data = grp->safeoutputs + (data - grp->outputs);
+      }
+      /* counted before the frame leaves, see ecx_mbxwaitmapped() */
+      if (grp->status && (((uint8 *)dg[i].rxdata + dg[i].rxskip) == grp->status))
+      {
+         osal_atomic_store(&grp->statussent, grp->statussent + 1);
+      }
+      if (dg[i].rxoffset == EC_HEADERSIZE)
+      {
+         /* get new index */
+         idx = ecx_getindex(context->port);
+         ecx_setupdatagram(context->port, &(context->port->txbuf[idx]), dg[i].cmd, idx,
+                           dg[i].ADP, dg[i].ADO, dg[i].length, data);
+      }
+      else
+      {
+         ecx_adddatagram(context->port, &(context->port->txbuf[idx]), dg[i].cmd, idx,
+                         dg[i].more, dg[i].ADP, dg[i].ADO, dg[i].length, data);
+      }
+      ecx_pushindex(idxstack, idx, (uint8 *)dg[i].rxdata + dg[i].rxskip,
+                    (uint16)(dg[i].length - dg[i].rxskip), dg[i].cmd,
+                    (uint16)(dg[i].rxoffset + dg[i].rxskip), dg[i].group);
+      idxstack->seq[idxstack->pushed - 1] = dg[i].seq;
+      /* send frame */
+      if (!dg[i].more)
+      {
+         ecx_outframe_red(context->port, idx);
+      }
+   }
+}
+
+/** Add the process data datagrams of one group to the datagram list.
+ * Uses LRW, or LRD/LWR if LRW is not allowed (blockLRW). With DC quality
+ * monitoring a FPRD of the system time difference of the next DC slaves
+ * follows, in diagnostics mode a FPRD of the AL status of every slave of
+ * the group.
  * @param[in]  context        = context struct
  * @param[in]  group          = group number
- * @return >0 if processdata is transmitted.
+ * @param[in,out] dg          = datagram list
+ * @param[in,out] n           = number of datagrams in list
+ * @return >0 if the group has process data.
  */
-int ecx_send_processdata_group(ecx_contextt *context, uint8 group)
+static int ecx_groupdatagrams(ecx_contextt *context, uint8 group, ec_pdatagramt *dg, int *n)
 {
    uint32 LogAdr;
-   uint16 w1, w2;
-   int length, sublength;
-   uint8 idx;
+   int length, sublength, skip, i;
    int wkc;
    uint8* data;
-   boolean first=FALSE;
+   uint8 *odata, *idata;
    uint16 currentsegment = 0;
+   uint16 slave;
+   ec_groupt *grp;
 
    wkc = 0;
-   if(context->grouplist[group].hasdc)
+   grp = &context->grouplist[group];
+   length = grp->Obytes + grp->Ibytes;
+   LogAdr = grp->logstartaddr;
+   if (length && grp->overlap)
    {
-      first = TRUE;
+      wkc = 1;
+      /* inputs and outputs share the logical range, Obytes is its size */
+      length = grp->Obytes;
+      odata = grp->outputs;
+      idata = grp->inputs;
+      do
+      {
+         sublength = grp->IOsegment[currentsegment++];
+         /* LRW blocked by one or more slaves ? */
+         if (grp->blockLRW)
+         {
+            ecx_adddg(dg, n, EC_CMD_LRD, LO_WORD(LogAdr), HI_WORD(LogAdr), sublength, idata, idata,
+                      0, group);
+            ecx_adddg(dg, n, EC_CMD_LWR, LO_WORD(LogAdr), HI_WORD(LogAdr), sublength, odata, odata,
+                      0, group);
+         }
+         else
+         {
+            /* response goes to the inputs so the outputs stay untouched */
+            ecx_adddg(dg, n, EC_CMD_LRW, LO_WORD(LogAdr), HI_WORD(LogAdr), sublength, odata, idata,
+                      0, group);
+         }
+         length -= sublength;
+         LogAdr += sublength;
+         odata += sublength;
+         idata += sublength;
+      } while (length && (currentsegment < grp->nsegments));
    }
-   length = context->grouplist[group].Obytes + context->grouplist[group].Ibytes;
-   LogAdr = context->grouplist[group].logstartaddr;
-   if (length)
+   else if (length)
    {
-      if(!group)
-      {
-         context->idxstack->pushed = 0;
-         context->idxstack->pulled = 0;
-      }
       wkc = 1;
       /* LRW blocked by one or more slaves ? */
-      if (context->grouplist[group].blockLRW)
+      if (grp->blockLRW)
       {
          /* if inputs available generate LRD */
-         if(context->grouplist[group].Ibytes)
+         if(grp->Ibytes)
          {
-            currentsegment = context->grouplist[group].Isegment;
-            data = context->grouplist[group].inputs;
-            length = context->grouplist[group].Ibytes;
-            LogAdr += context->grouplist[group].Obytes;
+            currentsegment = grp->Isegment;
+            data = grp->inputs;
+            length = grp->Ibytes;
+            LogAdr += grp->Obytes;
             /* segment transfer if needed */
             do
             {
-               if(currentsegment == context->grouplist[group].Isegment)
+               if(currentsegment == grp->Isegment)
                {
-                  sublength = context->grouplist[group].IOsegment[currentsegment++] - context->grouplist[group].Ioffset;
+                  sublength = grp->IOsegment[currentsegment++] - grp->Ioffset;
                }
                else
                {
-                  sublength = context->grouplist[group].IOsegment[currentsegment++];
-               }
-               /* get new index */
-               idx = ecx_getindex(context->port);
-               w1 = LO_WORD(LogAdr);
-               w2 = HI_WORD(LogAdr);
-               ecx_setupdatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_LRD, idx, w1, w2, sublength, data);
-               if(first)
-               {
-                  context->DCl = sublength;
-                  /* FPRMW in second datagram */
-                  context->DCtO = ecx_adddatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_FRMW, idx, FALSE,
-                                           context->slavelist[context->grouplist[group].DCnext].configadr,
-                                           ECT_REG_DCSYSTIME, sizeof(context->DCtime), context->DCtime);
-                  first = FALSE;
+                  sublength = grp->IOsegment[currentsegment++];
                }
-               /* send frame */
-               ecx_outframe_red(context->port, idx);
-               /* push index and data pointer on stack */
-               ecx_pushindex(context, idx, data, sublength);
+               ecx_adddg(dg, n, EC_CMD_LRD, LO_WORD(LogAdr), HI_WORD(LogAdr), sublength, data, data,
+                         0, group);
                length -= sublength;
                LogAdr += sublength;
                data += sublength;
-            } while (length && (currentsegment < context->grouplist[group].nsegments));
+            } while (length && (currentsegment < grp->nsegments));
          }
          /* if outputs available generate LWR */
-         if(context->grouplist[group].Obytes)
+         if(grp->Obytes)
          {
-            data = context->grouplist[group].outputs;
-            length = context->grouplist[group].Obytes;
-            LogAdr = context->grouplist[group].logstartaddr;
+            data = grp->outputs;
+            length = grp->Obytes;
+            LogAdr = grp->logstartaddr;
             currentsegment = 0;
             /* segment transfer if needed */
             do
             {
-               sublength = context->grouplist[group].IOsegment[currentsegment++];
+               sublength = grp->IOsegment[currentsegment++];
                if((length - sublength) < 0)
                {
                   sublength = length;
                }
-               /* get new index */
-               idx = ecx_getindex(context->port);
-               w1 = LO_WORD(LogAdr);
-               w2 = HI_WORD(LogAdr);
-               ecx_setupdatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_LWR, idx, w1, w2, sublength, data);
-               if(first)
-               {
-                  context->DCl = sublength;
-                  /* FPRMW in second datagram */
-                  context->DCtO = ecx_adddatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_FRMW, idx, FALSE,
-                                           context->slavelist[context->grouplist[group].DCnext].configadr,
-                                           ECT_REG_DCSYSTIME, sizeof(context->DCtime), context->DCtime);
-                  first = FALSE;
-               }
-               /* send frame */
-               ecx_outframe_red(context->port, idx);
-               /* push index and data pointer on stack */
-               ecx_pushindex(context, idx, data, sublength);
+               ecx_adddg(dg, n, EC_CMD_LWR, LO_WORD(LogAdr), HI_WORD(LogAdr), sublength, data, data,
+                         0, group);
                length -= sublength;
                LogAdr += sublength;
                data += sublength;
-            } while (length && (currentsegment < context->grouplist[group].nsegments));
+            } while (length && (currentsegment < grp->nsegments));
          }
       }
       /* LRW can be used */
       else
       {
-         if (context->grouplist[group].Obytes)
+         if (grp->Obytes)
          {
-            data = context->grouplist[group].outputs;
+            data = grp->outputs;
          }
          else
          {
-            data = context->grouplist[group].inputs;
+            data = grp->inputs;
          }
+         skip = grp->Obytes;
          /* segment transfer if needed */
          do
          {
-            sublength = context->grouplist[group].IOsegment[currentsegment++];
-            /* get new index */
-            idx = ecx_getindex(context->port);
-            w1 = LO_WORD(LogAdr);
-            w2 = HI_WORD(LogAdr);
-            ecx_setupdatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_LRW, idx, w1, w2, sublength, data);
-            if(first)
-            {
-               context->DCl = sublength;
-               /* FPRMW in second datagram */
-               context->DCtO = ecx_adddatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_FRMW, idx, FALSE,
-                                        context->slavelist[context->grouplist[group].DCnext].configadr,
-                                        ECT_REG_DCSYSTIME, sizeof(context->DCtime), context->DCtime);
-               first = FALSE;
-            }
-            /* send frame */
-            ecx_outframe_red(context->port, idx);
-            /* push index and data pointer on stack */
-            ecx_pushindex(context, idx, data, sublength);
+            sublength = grp->IOsegment[currentsegment++];
+            /* the echo of the outputs is not copied back, the application may
+             * already have written the outputs of the next cycle */
+            ecx_adddg(dg, n, EC_CMD_LRW, LO_WORD(LogAdr), HI_WORD(LogAdr), sublength, data, data,
+                      (uint16)((skip < sublength) ? skip : sublength), group);
+            skip = (skip > sublength) ? (skip - sublength) : 0;
             length -= sublength;
             LogAdr += sublength;
             data += sublength;
-         } while (length && (currentsegment < context->grouplist[group].nsegments));
+         } while (length && (currentsegment < grp->nsegments));
       }
    }
-
-   return wkc;
-}
-
-/** Receive processdata from slaves.
- * Second part from ec_send_processdata().
- * Received datagrams are recombined with the processdata with help from the stack.
- * If a datagram contains input processdata it copies it to the processdata structure.
- * @param[in]  context        = context struct
- * @param[in]  group          = group number
- * @param[in]  timeout        = Timeout in us.
- * @return Work counter.
- */
-int ecx_receive_processdata_group(ecx_contextt *context, uint8 group, int timeout)
-{
-   int pos, idx;
-   int wkc = 0, wkc2;
-   uint16 le_wkc = 0;
-   int64 le_DCtime;
-   boolean first = FALSE;
-
-   if(context->grouplist[group].hasdc)
+   if (wkc && grp->cyclicstatus && grp->statusbytes)
    {
-      first = TRUE;
+      /* mapped AL status of all slaves, zeros are sent so a lost slave reads 0 */
+      ecx_adddg(dg, n, EC_CMD_LRD, LO_WORD(grp->statuslogaddr), HI_WORD(grp->statuslogaddr),
+                grp->statusbytes, grp->status + grp->statusbytes, grp->status, 0, group);
    }
-   /* get first index */
-   pos = ecx_pullindex(context);
-   /* read the same number of frames as send */
-   while (pos >= 0)
+   if (wkc && grp->dcqual)
    {
-      idx = context->idxstack->idx[pos];
-      wkc2 = ecx_waitinframe(context->port, context->idxstack->idx[pos], timeout);
-      /* check if there is input data in frame */
-      if (wkc2 > EC_NOFRAME)
+      /* system time difference of the next DC slaves, rotated every send */
+      for (i = 0; i < grp->dcqualsubset; i++)
       {
-         if((context->port->rxbuf[idx][EC_CMDOFFSET]==EC_CMD_LRD) || (context->port->rxbuf[idx][EC_CMDOFFSET]==EC_CMD_LRW))
-         {
-            if(first)
-            {
-               memcpy(context->idxstack->data[pos], &(context->port->rxbuf[idx][EC_HEADERSIZE]), context->DCl);
-               memcpy(&le_wkc, &(context->port->rxbuf[idx][EC_HEADERSIZE + context->DCl]), EC_WKCSIZE);
-               wkc = etohs(le_wkc);
-               memcpy(&le_DCtime, &(context->port->rxbuf[idx][context->DCtO]), sizeof(le_DCtime));
-               *(context->DCtime) = etohll(le_DCtime);
-               first = FALSE;
-            }
-            else
-            {
-               /* copy input data back to process data buffer */
-               memcpy(context->idxstack->data[pos], &(context->port->rxbuf[idx][EC_HEADERSIZE]), context->idxstack->length[pos]);
-               wkc += wkc2;
-            }
-         }
-         else if(context->port->rxbuf[idx][EC_CMDOFFSET]==EC_CMD_LWR)
+         slave = ecx_dcquality_next(context, group);
+         ecx_adddg(dg, n, EC_CMD_FPRD, context->slavelist[slave].configadr, ECT_REG_DCSYSDIFF,
+                   sizeof(uint32), &grp->dcqual[slave], &grp->dcqual[slave], 0, group);
+      }
+   }
+   if (wkc && grp->diag)
+   {
+      /* AL status of every slave of the group, the work counter of the
+       * FPRD tells if the slave responded. Slaves with mapped AL status are
+       * read by the status LRD. */
+      for (slave = 1; slave <= *(context->slavecount); slave++)
+      {
+         if ((!group || (group == context->slavelist[slave].group)) &&
+             !(grp->cyclicstatus && grp->statusbytes && context->slavelist[slave].alstatus))
          {
-            if(first)
-            {
-               memcpy(&le_wkc, &(context->port->rxbuf[idx][EC_HEADERSIZE + context->DCl]), EC_WKCSIZE);
-               /* output WKC counts 2 times when using LRW, emulate the same for LWR */
-               wkc = etohs(le_wkc) * 2;
-               memcpy(&le_DCtime, &(context->port->rxbuf[idx][context->DCtO]), sizeof(le_DCtime));
-               *(context->DCtime) = etohll(le_DCtime);
-               first = FALSE;
-            }
-            else
-            {
-               /* output WKC counts 2 times when using LRW, emulate the same for LWR */
-               wkc += wkc2 * 2;
-            }
+            ecx_adddg(dg, n, EC_CMD_FPRD, context->slavelist[slave].configadr, ECT_REG_ALSTAT,
+                      sizeof(ec_alstatust), context->slavelist[slave].diagbuf,
+                      context->slavelist[slave].diagbuf, 0, group);
          }
       }
-      /* release buffer */
-      ecx_setbufstat(context->port, idx, EC_BUF_EMPTY);
-      /* get next index */
-      pos = ecx_pullindex(context);
    }
 
    return wkc;
 }
 
+/** Insert the FRMW of the DC time directly after the first datagram of the
+ * list, the first segment has room reserved for it.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group with DC
+ * @param[in,out] dg          = datagram list
+ * @param[in,out] n           = number of datagrams in list
+ */
+static void ecx_dcdatagram(ecx_contextt *context, uint8 group, ec_pdatagramt *dg, int *n)
+{
+   if (*n && (*n < EC_MAXIDXSTACK))
+   {
+      memmove(&dg[2], &dg[1], sizeof(ec_pdatagramt) * (*n - 1));
+      (*n)++;
+      dg[1].cmd = EC_CMD_FRMW;
+      dg[1].ADP = context->slavelist[context->grouplist[group].DCnext].configadr;
+      dg[1].ADO = ECT_REG_DCSYSTIME;
+      dg[1].length = sizeof(int64);
+      dg[1].data = context->DCtime;
+      dg[1].rxdata = context->DCtime;
+      dg[1].rxskip = 0;
+      dg[1].group = group;
+   }
+}
+
+/** Build the frame plan of a group. The plan holds the datagrams of a send
+ * of the group alone and their layout in frames, so the send does not
+ * have to take any decision on the group layout every cycle. Called by
+ * the IOmap configuration and ecx_configdc(), call again when the group
+ * is changed by hand.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ * @return Number of datagrams in the plan, 0 if the group is sent without plan.
+ */
+int ecx_frameplan_build(ecx_contextt *context, uint8 group)
+{
+   ec_groupt *grp;
+   int n = 0;
+
+   if (group >= context->maxgroup)
+   {
+      return 0;
+   }
+   grp = &context->grouplist[group];
+   grp->nplan = 0;
+   /* zero copy groups have their own frames */
+   if (grp->zerocopy || !ecx_groupdatagrams(context, group, grp->plan, &n))
+   {
+      return 0;
+   }
+   if (grp->hasdc)
+   {
+      ecx_dcdatagram(context, group, grp->plan, &n);
+   }
+   ecx_layoutdatagrams(grp->plan, n);
+   grp->nplan = (uint16)n;
+
+   return n;
+}
+
+/** Number of datagrams of a send of a group alone with all its enabled
+ * options, to check them against EC_MAXIDXSTACK before enabling one.
+ * With blockLRW every segment is counted for both LRD and LWR.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ * @return Number of datagrams.
+ */
+int ecx_groupdatagramcount(ecx_contextt *context, uint8 group)
+{
+   ec_groupt *grp;
+   uint16 slave;
+   int n;
+
+   grp = &context->grouplist[group];
+   /* process data, DC time, mapped status and DC quality reads */
+   n = grp->nsegments * (grp->blockLRW ? 2 : 1) + (grp->hasdc ? 1 : 0) +
+       ((grp->cyclicstatus && grp->statusbytes) ? 1 : 0) +
+       (grp->dcqual ? grp->dcqualsubset : 0);
+   /* one AL status read per slave in diagnostics mode, unless mapped */
+   if (grp->diag)
+   {
+      for (slave = 1; slave <= *(context->slavecount); slave++)
+      {
+         if ((!group || (group == context->slavelist[slave].group)) &&
+             !(grp->cyclicstatus && grp->statusbytes && context->slavelist[slave].alstatus))
+         {
+            n++;
+         }
+      }
+   }
+
+   return n;
+}
+
+/** Bytes on the wire per send of a group alone, from the frame plan or
+ * from the datagrams a send would build. Every frame counts with at least
+ * the Ethernet minimum size plus FCS, preamble and inter frame gap.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ * @param[out] nframes        = number of frames, can be NULL
+ * @return Bytes on the wire, 0 for a zero copy group or without process data.
+ */
+int ecx_frameplan_wirebytes(ecx_contextt *context, uint8 group, int *nframes)
+{
+   ec_groupt *grp;
+   ec_pdatagramt dg[EC_MAXIDXSTACK];
+   const ec_pdatagramt *list;
+   int i, n = 0, frames = 0, size, bytes = 0;
+
+   if (nframes)
+   {
+      *nframes = 0;
+   }
+   if (group >= context->maxgroup)
+   {
+      return 0;
+   }
+   grp = &context->grouplist[group];
+   list = grp->plan;
+   n = grp->nplan;
+   if (!n && !grp->zerocopy && ecx_groupdatagrams(context, group, dg, &n))
+   {
+      if (grp->hasdc)
+      {
+         ecx_dcdatagram(context, group, dg, &n);
+      }
+      ecx_layoutdatagrams(dg, n);
+      list = dg;
+   }
+   for (i = 0; i < n; i++)
+   {
+      /* the last datagram of a frame gives the frame size */
+      if (!list[i].more)
+      {
+         size = ETH_HEADERSIZE + list[i].rxoffset + list[i].length + EC_WKCSIZE;
+         bytes += ((size < EC_MINETHFRAME) ? EC_MINETHFRAME : size) + EC_ETHOVERHEAD;
+         frames++;
+      }
+   }
+   if (nframes)
+   {
+      *nframes = frames;
+   }
+
+   return bytes;
+}
+
+/** Enable or disable per slave diagnostics of a group. With every send of
+ * the group the AL status of each of its slaves is read with a FPRD in the
+ * same frames as the process data. After the receive ecx_diag_check()
+ * tells which slave failed, without any extra round trip. Every slave
+ * takes one datagram of EC_MAXIDXSTACK (64, max. 255), so groups with more
+ * slaves are refused. For large groups map the AL status (ec_groupt
+ * mapstatus) and enable ecx_statusmap_cyclic() first, the slaves with
+ * mapped AL status are then covered by its single LRD and take no FPRD.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ * @param[in]  enable         = TRUE to enable, FALSE to disable
+ * @return 1 if done, 0 if the datagrams do not fit or the group is zero copy
+ */
+int ecx_diag_enable(ecx_contextt *context, uint8 group, boolean enable)
+{
+   ec_groupt *grp;
+   uint16 slave;
+
+   if (group >= context->maxgroup)
+   {
+      return 0;
+   }
+   grp = &context->grouplist[group];
+   if (enable && !grp->diag)
+   {
+      grp->diag = TRUE;
+      if (grp->zerocopy || (ecx_groupdatagramcount(context, group) > EC_MAXIDXSTACK))
+      {
+         grp->diag = FALSE;
+         return 0;
+      }
+      for (slave = 1; slave <= *(context->slavecount); slave++)
+      {
+         if (!group || (group == context->slavelist[slave].group))
+         {
+            memset(context->slavelist[slave].diagbuf, 0, sizeof(context->slavelist[slave].diagbuf));
+         }
+      }
+   }
+   grp->diag = enable;
+   ecx_frameplan_build(context, group);
+
+   return 1;
+}
+
+/** Evaluate the per slave diagnostics of the last receive of a group.
+ * The AL status and AL status code of every slave of the group are copied
+ * to the slavelist, a slave that did not respond gets state 0.
+ * Use instead of ecx_readstate() when the group work counter is too low.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ * @return First slave of the group that is not OPERATIONAL, 0 if all are
+ * or diagnostics are not enabled.
+ */
+uint16 ecx_diag_check(ecx_contextt *context, uint8 group)
+{
+   ec_slavet *sl;
+   uint16 slave, failed = 0;
+
+   if ((group >= context->maxgroup) || !context->grouplist[group].diag)
+   {
+      return 0;
+   }
+   for (slave = 1; slave <= *(context->slavecount); slave++)
+   {
+      sl = &context->slavelist[slave];
+      if (group && (group != sl->group))
+      {
+         continue;
+      }
+      if (context->grouplist[group].cyclicstatus && sl->alstatus)
+      {
+         /* mapped AL status, the AL status code is not mapped */
+         sl->state = sl->alstatus[0] + ((uint16)sl->alstatus[1] << 8);
+      }
+      else if (etohs(sl->diagbuf[3]))
+      {
+         sl->state = etohs(sl->diagbuf[0]);
+         sl->ALstatuscode = etohs(sl->diagbuf[2]);
+      }
+      else
+      {
+         sl->state = 0;
+      }
+      if (!failed && (sl->state != EC_STATE_OPERATIONAL))
+      {
+         failed = slave;
+      }
+   }
+
+   return failed;
+}
+
+/** Expected work counter of a process data datagram, from the FMMUs of the
+ * slaves of the group. A slave counts 1 for read and 2 for write access,
+ * the LWR work counter is doubled on completion.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ * @param[in]  dg             = datagram
+ * @return Expected work counter.
+ */
+static uint16 ecx_expectedwkc(ecx_contextt *context, uint8 group, const ec_pdatagramt *dg)
+{
+   ec_slavet *sl;
+   uint32 LogAdr, start;
+   uint16 slave, wkc = 0;
+   boolean rd, wr;
+   int i;
+
+   LogAdr = dg->ADP + ((uint32)dg->ADO << 16);
+   for (slave = 1; slave <= *(context->slavecount); slave++)
+   {
+      sl = &context->slavelist[slave];
+      if (group && (group != sl->group))
+      {
+         continue;
+      }
+      rd = wr = FALSE;
+      for (i = 0; i < EC_MAXFMMU; i++)
+      {
+         start = etohl(sl->FMMU[i].LogStart);
+         if (sl->FMMU[i].FMMUactive && (start < (LogAdr + dg->length)) &&
+             ((start + etohs(sl->FMMU[i].LogLength)) > LogAdr))
+         {
+            rd |= (sl->FMMU[i].FMMUtype == 1);
+            wr |= (sl->FMMU[i].FMMUtype == 2);
+         }
+      }
+      if (rd && (dg->cmd != EC_CMD_LWR))
+      {
+         wkc++;
+      }
+      if (wr && (dg->cmd != EC_CMD_LRD))
+      {
+         wkc += 2;
+      }
+   }
+
+   return wkc;
+}
+
+/** Enable or disable input age tracking per slave of a group. Every
+ * process data datagram of the group gets the receive cycle stamped when it
+ * arrives with its expected work counter, the slaves know the datagrams
+ * that carry their inputs. ecx_fresh_age() then tells per slave how old its
+ * inputs are, without scanning anything. Call after the group is mapped,
+ * enable again after a remap.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ * @param[in]  enable         = TRUE to enable, FALSE to disable
+ * @return 1 if done, 0 if the group has no process data or is zero copy
+ */
+int ecx_fresh_enable(ecx_contextt *context, uint8 group, boolean enable)
+{
+   ec_groupt *grp;
+   ec_slavet *sl;
+   ec_pdatagramt dg[EC_MAXIDXSTACK];
+   uint8 *start, *end, *inputs;
+   uint16 slave;
+   int i, n = 0;
+
+   if (group >= context->maxgroup)
+   {
+      return 0;
+   }
+   grp = &context->grouplist[group];
+   if (!enable)
+   {
+      grp->fresh = FALSE;
+      return 1;
+   }
+   if (grp->zerocopy || !ecx_groupdatagrams(context, group, dg, &n))
+   {
+      return 0;
+   }
+   ecx_layoutdatagrams(dg, n);
+   grp->fresh = FALSE;
+   grp->rxcycle = 0;
+   memset(grp->freshwkc, 0, sizeof(grp->freshwkc));
+   memset(grp->freshcycle, 0, sizeof(grp->freshcycle));
+   for (slave = 1; slave <= *(context->slavecount); slave++)
+   {
+      context->slavelist[slave].nfreshseq = 0;
+   }
+   for (i = 0; i < n; i++)
+   {
+      if (!ecx_islogical(dg[i].cmd))
+      {
+         continue;
+      }
+      grp->freshwkc[dg[i].seq] = ecx_expectedwkc(context, group, &dg[i]);
+      if (dg[i].cmd == EC_CMD_LWR)
+      {
+         continue;
+      }
+      /* inputs covered by the response */
+      start = (uint8 *)dg[i].rxdata + dg[i].rxskip;
+      end = (uint8 *)dg[i].rxdata + dg[i].length;
+      for (slave = 1; slave <= *(context->slavecount); slave++)
+      {
+         sl = &context->slavelist[slave];
+         inputs = sl->inputs;
+         if ((group && (group != sl->group)) || !inputs || !(sl->Ibytes || sl->Ibits) ||
+             (inputs >= end) || ((inputs + (sl->Ibytes ? sl->Ibytes : 1)) <= start))
+         {
+            continue;
+         }
+         if (!sl->nfreshseq)
+         {
+            sl->freshseq = dg[i].seq;
+         }
+         sl->nfreshseq = (uint8)(dg[i].seq - sl->freshseq + 1);
+      }
+   }
+   grp->fresh = TRUE;
+
+   return 1;
+}
+
+/** Age of the inputs of a slave. O(1), reads only the stamps of the
+ * datagrams carrying the inputs of the slave.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number, as used for ecx_fresh_enable()
+ * @param[in]  slave          = slave number
+ * @return Number of receive cycles since the inputs were last valid, 0 if
+ * valid in the last cycle, the cycles since ecx_fresh_enable() if never
+ * valid. -1 if not tracked.
+ */
+int32 ecx_fresh_age(ecx_contextt *context, uint8 group, uint16 slave)
+{
+   ec_groupt *grp;
+   ec_slavet *sl;
+   uint32 age, maxage = 0;
+   int seq;
+
+   if ((group >= context->maxgroup) || (slave > *(context->slavecount)) ||
+       !context->grouplist[group].fresh || !context->slavelist[slave].nfreshseq)
+   {
+      return -1;
+   }
+   grp = &context->grouplist[group];
+   sl = &context->slavelist[slave];
+   for (seq = sl->freshseq; seq < (sl->freshseq + sl->nfreshseq); seq++)
+   {
+      age = grp->rxcycle - grp->freshcycle[seq];
+      if (age > maxage)
+      {
+         maxage = age;
+      }
+   }
+
+   return (maxage > 0x7fffffff) ? 0x7fffffff : (int32)maxage;
+}
+
+/** Attach a safe output image to a group. When the group work counter is
+ * below the expected outputsWKC * 2 + inputsWKC for threshold receive
+ * cycles in a row, every following send transmits the safe image instead of
+ * the outputs, until ecx_safe_release(). Switching only changes the source
+ * of the transmitted data, nothing is copied in the cycle. The application
+ * keeps writing the outputs as usual. Without overlap the safe image has
+ * the layout of the outputs followed by the inputs, the input part is
+ * transmitted but its content does not matter.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ * @param[in]  safe           = safe output image
+ * @param[in]  size           = size of safe image, Obytes with overlap, else Obytes + Ibytes
+ * @param[in]  threshold      = cycles with a low work counter until switching, 1 = at once
+ * @return 1 if attached, 0 on invalid arguments or zero copy group
+ */
+int ecx_safe_attach(ecx_contextt *context, uint8 group, uint8 *safe, uint32 size,
+                    uint16 threshold)
+{
+   ec_groupt *grp;
+
+   if ((group >= context->maxgroup) || !safe || !threshold)
+   {
+      return 0;
+   }
+   grp = &context->grouplist[group];
+   if (grp->zerocopy ||
+       (size < (grp->overlap ? grp->Obytes : (grp->Obytes + grp->Ibytes))))
+   {
+      return 0;
+   }
+   grp->safeactive = FALSE;
+   grp->safecount = 0;
+   grp->safethreshold = threshold;
+   grp->safeoutputs = safe;
+
+   return 1;
+}
+
+/** Detach the safe output image from a group, the outputs are sent again.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ */
+void ecx_safe_detach(ecx_contextt *context, uint8 group)
+{
+   if (group < context->maxgroup)
+   {
+      context->grouplist[group].safeoutputs = NULL;
+      context->grouplist[group].safeactive = FALSE;
+   }
+}
+
+/** Send the outputs again after the safe image was switched in. Call when
+ * communication is restored and the outputs hold valid values.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ */
+void ecx_safe_release(ecx_contextt *context, uint8 group)
+{
+   if (group < context->maxgroup)
+   {
+      context->grouplist[group].safecount = 0;
+      context->grouplist[group].safeactive = FALSE;
+   }
+}
+
+/** Read the AL status of all slaves of a group with the process data.
+ * Needs the AL status mapped, see ec_groupt mapstatus. One LRD is appended
+ * to the process data datagrams, evaluate with ecx_statusmap_check() after
+ * the receive. In diagnostics mode the slaves with mapped AL status are
+ * covered by this LRD instead of their own FPRD, see ecx_diag_enable().
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ * @param[in]  enable         = TRUE to enable, FALSE to disable
+ * @return 1 if done, 0 if the AL status is not mapped, the group is zero copy
+ * or the datagrams do not fit on the index stack
+ */
+int ecx_statusmap_cyclic(ecx_contextt *context, uint8 group, boolean enable)
+{
+   ec_groupt *grp;
+
+   if (group >= context->maxgroup)
+   {
+      return 0;
+   }
+   grp = &context->grouplist[group];
+   if (enable && !grp->cyclicstatus)
+   {
+      grp->cyclicstatus = TRUE;
+      if (!grp->statusbytes || grp->zerocopy ||
+          (ecx_groupdatagramcount(context, group) > EC_MAXIDXSTACK))
+      {
+         grp->cyclicstatus = FALSE;
+         return 0;
+      }
+   }
+   else if (!enable && grp->cyclicstatus)
+   {
+      /* in diagnostics mode the slaves fall back to one FPRD each */
+      grp->cyclicstatus = FALSE;
+      if (ecx_groupdatagramcount(context, group) > EC_MAXIDXSTACK)
+      {
+         grp->cyclicstatus = TRUE;
+         return 0;
+      }
+   }
+   grp->cyclicstatus = enable;
+   ecx_frameplan_build(context, group);
+
+   return 1;
+}
+
+/** Read the mapped AL status of all slaves of a group with one LRD, instead
+ * of one FPRD per slave. Evaluate with ecx_statusmap_check().
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ * @param[in]  timeout        = Timeout in us, standard is EC_TIMEOUTRET
+ * @return Work counter, one per responding slave, or EC_NOFRAME
+ */
+int ecx_statusmap_read(ecx_contextt *context, uint8 group, int timeout)
+{
+   ec_groupt *grp;
+   int wkc;
+
+   if ((group >= context->maxgroup) || !context->grouplist[group].statusbytes)
+   {
+      return 0;
+   }
+   grp = &context->grouplist[group];
+   /* a slave that does not respond reads as state 0 */
+   memset(grp->status, 0, grp->statusbytes);
+   wkc = ecx_LRD(context->port, grp->statuslogaddr, grp->statusbytes, grp->status, timeout);
+   grp->statuswkc = (wkc > 0) ? wkc : 0;
+
+   return wkc;
+}
+
+/** Evaluate the mapped AL status of the last read of a group. The AL status
+ * of every mapped slave is copied to the slavelist state, a slave that did
+ * not respond gets state 0. The AL status code is not mapped, read it with
+ * ecx_readstate() for the failed slaves.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ * @return First slave of the group that is not OPERATIONAL, 0 if all are
+ * or the AL status is not mapped.
+ */
+uint16 ecx_statusmap_check(ecx_contextt *context, uint8 group)
+{
+   ec_slavet *sl;
+   uint16 slave, failed = 0;
+
+   if ((group >= context->maxgroup) || !context->grouplist[group].statusbytes)
+   {
+      return 0;
+   }
+   for (slave = 1; slave <= *(context->slavecount); slave++)
+   {
+      sl = &context->slavelist[slave];
+      if ((group && (group != sl->group)) || !sl->alstatus)
+      {
+         continue;
+      }
+      sl->state = sl->alstatus[0] + ((uint16)sl->alstatus[1] << 8);
+      if (!failed && (sl->state != EC_STATE_OPERATIONAL))
+      {
+         failed = slave;
+      }
+   }
+
+   return failed;
+}
+
+/** Attach an acyclic datagram queue to the sends of a group. Posted
+ * datagrams are appended to the last frame of the next send of the group
+ * as long as they fit in the frame, so they do not take an extra frame and
+ * round trip. Only the sends of this one group take from the queue, the
+ * other groups and the blocking primitives like ecx_FPRD() are not
+ * affected. Zero copy groups have no room in their frames and take nothing.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ * @param[in]  queue          = queue storage, must stay valid until detached
+ * @return 1 if done, 0 if already attached
+ */
+int ecx_acyclic_attach(ecx_contextt *context, uint8 group, ec_acyclicqt *queue)
+{
+   if ((group >= context->maxgroup) || context->acyclicq)
+   {
+      return 0;
+   }
+   memset(queue, 0, sizeof(ec_acyclicqt));
+   queue->group = group;
+   osal_mpsc_init(&queue->ring, queue->buf, EC_MAXACYCLIC, sizeof(ec_acyclict *));
+   context->acyclicq = queue;
+
+   return 1;
+}
+
+/** Complete an acyclic request.
+ * @param[in]  req            = request
+ * @param[in]  wkc            = work counter or EC_NOFRAME
+ */
+static void ecx_acyclic_complete(ec_acyclict *req, int wkc)
+{
+   req->wkc = wkc;
+   osal_atomic_store(&req->state, EC_ACYCLIC_DONE);
+}
+
+/** Detach the acyclic datagram queue, call after the last receive of the
+ * group. Requests still queued are completed with EC_NOFRAME.
+ * @param[in]  context        = context struct
+ */
+void ecx_acyclic_detach(ecx_contextt *context)
+{
+   ec_acyclicqt *queue;
+   ec_acyclict *req;
+
+   queue = context->acyclicq;
+   if (!queue)
+   {
+      return;
+   }
+   context->acyclicq = NULL;
+   if (queue->carry)
+   {
+      ecx_acyclic_complete(queue->carry, EC_NOFRAME);
+      queue->carry = NULL;
+   }
+   while (osal_mpsc_pop(&queue->ring, &req))
+   {
+      ecx_acyclic_complete(req, EC_NOFRAME);
+   }
+}
+
+/** Post an acyclic datagram, safe from any thread. The datagram is sent
+ * with the process data of the queue group and completed by its receive,
+ * wait for it with ecx_acyclic_wait(). Datagram data larger than a frame
+ * can hold is refused, a datagram that does not fit in the room left in
+ * the last frame of the group is completed with EC_ERROR by the send.
+ * @param[in]  context        = context struct
+ * @param[in]  req            = request, cmd, ADP, ADO, length and data set
+ * @return 1 if queued, 0 if no queue is attached, the queue is full or
+ * the request is still in use
+ */
+int ecx_acyclic_post(ecx_contextt *context, ec_acyclict *req)
+{
+   uint32 state;
+
+   state = osal_atomic_load(&req->state);
+   if (!context->acyclicq || ((state != EC_ACYCLIC_IDLE) && (state != EC_ACYCLIC_DONE)) ||
+       ((req->length + EC_HEADERSIZE + EC_WKCSIZE + ETH_HEADERSIZE) > EC_MAXFRAMELENGTH))
+   {
+      return 0;
+   }
+   req->wkc = 0;
+   osal_atomic_store(&req->state, EC_ACYCLIC_QUEUED);
+   if (!osal_mpsc_push(&context->acyclicq->ring, &req))
+   {
+      osal_atomic_store(&req->state, EC_ACYCLIC_IDLE);
+      return 0;
+   }
+
+   return 1;
+}
+
+/** Wait for an acyclic request to be done, checked every mailbox poll
+ * interval.
+ * @param[in]  context        = context struct
+ * @param[in]  req            = request posted with ecx_acyclic_post()
+ * @param[in]  timeout        = Timeout in us, 0 checks once
+ * @return Work counter of the response, EC_NOFRAME if the frame was lost,
+ * EC_ERROR if the datagram does not fit in the last frame of the group or
+ * EC_BUSY if not done yet. After EC_BUSY the request is still in use.
+ */
+int ecx_acyclic_wait(ecx_contextt *context, ec_acyclict *req, int timeout)
+{
+   osal_timert timer;
+
+   osal_timer_start(&timer, timeout);
+   while (osal_atomic_load(&req->state) != EC_ACYCLIC_DONE)
+   {
+      if (osal_timer_is_expired(&timer))
+      {
+         return EC_BUSY;
+      }
+      osal_usleep(EC_MBXPOLL(context));
+   }
+
+   return req->wkc;
+}
+
+/** Append queued acyclic datagrams to the last frame of laid out datagrams,
+ * as many as fit. A request that does not fit waits for the next send,
+ * unless it does not fit in the room of the last frame at all.
+ * @param[in]  context        = context struct
+ * @param[in,out] dg          = laid out datagram list
+ * @param[in,out] n           = number of datagrams in list
+ * @param[out] req            = appended requests
+ * @return Number of appended requests
+ */
+static int ecx_acyclicdatagrams(ecx_contextt *context, ec_pdatagramt *dg, int *n,
+                                ec_acyclict **req)
+{
+   ec_acyclicqt *queue;
+   ec_acyclict *next;
+   int size, nreq = 0;
+
+   queue = context->acyclicq;
+   /* size of the last frame */
+   size = ETH_HEADERSIZE + dg[*n - 1].rxoffset + dg[*n - 1].length + EC_WKCSIZE;
+   while (*n < EC_MAXIDXSTACK)
+   {
+      next = queue->carry;
+      queue->carry = NULL;
+      if (!next && !osal_mpsc_pop(&queue->ring, &next))
+      {
+         break;
+      }
+      if ((size + EC_HEADERSIZE - EC_ELENGTHSIZE + next->length + EC_WKCSIZE) > EC_MAXFRAMELENGTH)
+      {
+         /* first one of the send, the last frame will never have more room */
+         if (!nreq)
+         {
+            ecx_acyclic_complete(next, EC_ERROR);
+            continue;
+         }
+         queue->carry = next;
+         break;
+      }
+      dg[*n - 1].more = TRUE;
+      dg[*n].cmd = next->cmd;
+      dg[*n].ADP = next->ADP;
+      dg[*n].ADO = next->ADO;
+      dg[*n].length = next->length;
+      dg[*n].data = next->data;
+      dg[*n].rxdata = next->data;
+      dg[*n].rxskip = 0;
+      dg[*n].rxoffset = (uint16)(size - ETH_HEADERSIZE + EC_HEADERSIZE - EC_ELENGTHSIZE);
+      dg[*n].more = FALSE;
+      dg[*n].group = dg[*n - 1].group;
+      dg[*n].seq = 0;
+      size += EC_HEADERSIZE - EC_ELENGTHSIZE + next->length + EC_WKCSIZE;
+      osal_atomic_store(&next->state, EC_ACYCLIC_SENT);
+      req[nreq++] = next;
+      (*n)++;
+   }
+
+   return nreq;
+}
+
+/** Check for queued acyclic datagrams for a send.
+ * @param[in]  context        = context struct
+ * @param[in]  groups         = list of group numbers
+ * @param[in]  ngroups        = number of groups in list
+ * @return TRUE if the send takes acyclic datagrams.
+ */
+static boolean ecx_acyclicpending(ecx_contextt *context, const uint8 *groups, int ngroups)
+{
+   ec_acyclicqt *queue;
+   int i;
+
+   queue = context->acyclicq;
+   if (!queue || (!queue->carry && !osal_ring_count(&queue->ring)))
+   {
+      return FALSE;
+   }
+   for (i = 0; i < ngroups; i++)
+   {
+      if (groups[i] == queue->group)
+      {
+         return TRUE;
+      }
+   }
+
+   return FALSE;
+}
+
+/** Transmit the reserved frames of a zero copy group. The frames already
+ * hold the outputs, only the work counters are cleared.
+ * @param[in]  context        = context struct
+ * @param[in]  idxstack       = index stack of the send
+ * @param[in]  group          = group number
+ */
+static void ecx_zerocopy_send(ecx_contextt *context, ec_idxstackT *idxstack, uint8 group)
+{
+   ec_groupt *grp;
+   uint8 *frame;
+   uint16 seg, length;
+   uint8 idx;
+
+   grp = &context->grouplist[group];
+   for (seg = 0; seg < grp->nsegments; seg++)
+   {
+      idx = grp->zcidx[seg];
+      frame = (uint8 *)&(context->port->txbuf[idx]) + ETH_HEADERSIZE;
+      length = (uint16)grp->IOsegment[seg];
+      memset(frame + EC_HEADERSIZE + length, 0, EC_WKCSIZE);
+      ecx_pushindex(idxstack, idx, NULL, length, EC_CMD_LRW, EC_HEADERSIZE, group);
+      if (!seg && grp->zcdcoffset)
+      {
+         memset(frame + grp->zcdcoffset + sizeof(int64), 0, EC_WKCSIZE);
+         ecx_pushindex(idxstack, idx, context->DCtime, sizeof(int64), EC_CMD_FRMW,
+                       grp->zcdcoffset, group);
+      }
+      ecx_outframe_red(context->port, idx);
+   }
+}
+
+/** Point the DC quality reads of a frame plan to the next DC slaves, so
+ * the plan rotates over all DC slaves of the group like a send without plan.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ */
+static void ecx_dcqualityrotate(ecx_contextt *context, uint8 group)
+{
+   ec_groupt *grp;
+   uint16 slave;
+   int i;
+
+   grp = &context->grouplist[group];
+   for (i = 0; i < grp->nplan; i++)
+   {
+      if ((grp->plan[i].cmd == EC_CMD_FPRD) && (grp->plan[i].ADO == ECT_REG_DCSYSDIFF))
+      {
+         slave = ecx_dcquality_next(context, group);
+         grp->plan[i].ADP = context->slavelist[slave].configadr;
+         grp->plan[i].data = &grp->dcqual[slave];
+         grp->plan[i].rxdata = &grp->dcqual[slave];
+      }
+   }
+}
+
+/** Record the acyclic requests of the last datagrams on the index stack.
+ * @param[in]  idxstack       = index stack of the send
+ * @param[in]  req            = acyclic requests, last on the stack
+ * @param[in]  nreq           = number of requests
+ */
+static void ecx_acyclicstack(ec_idxstackT *idxstack, ec_acyclict **req, int nreq)
+{
+   int i, pos;
+
+   pos = idxstack->pushed - nreq;
+   for (i = 0; i < nreq; i++)
+   {
+      idxstack->acyclic[pos + i] = req[i];
+   }
+}
+
+/** Mark the last datagram of every group on the index stack, so a group
+ * is known to be complete without scanning the rest of the stack.
+ * @param[in]  idxstack       = index stack of the send
+ */
+static void ecx_stackmarklast(ec_idxstackT *idxstack)
+{
+   uint8 seen[EC_MAXGROUPLIST / 8];
+   uint8 group;
+   int pos;
+
+   memset(seen, 0, sizeof(seen));
+   for (pos = idxstack->pushed - 1; pos >= 0; pos--)
+   {
+      group = idxstack->group[pos];
+      idxstack->grouplast[pos] = FALSE;
+      if (!idxstack->acyclic[pos] && !(seen[group >> 3] & (1 << (group & 7))))
+      {
+         seen[group >> 3] |= (uint8)(1 << (group & 7));
+         idxstack->grouplast[pos] = TRUE;
+      }
+   }
+}
+
+/** Transmit processdata of several groups and record the datagrams on
+ * the given index stack.
+ * @param[in]  context        = context struct
+ * @param[in]  idxstack       = index stack of the send
+ * @param[in]  groups         = list of group numbers
+ * @param[in]  ngroups        = number of groups in list
+ * @return >0 if processdata is transmitted.
+ */
+static int ecx_send_processdata_stack(ecx_contextt *context, ec_idxstackT *idxstack,
+                                      const uint8 *groups, int ngroups)
+{
+   int wkc, n, i, dcgroup, nreq;
+   ec_groupt *grp;
+   ec_pdatagramt dg[EC_MAXIDXSTACK];
+   ec_acyclict *req[EC_MAXIDXSTACK];
+   boolean acyclic;
+
+   wkc = 0;
+   n = 0;
+   nreq = 0;
+   dcgroup = -1;
+   idxstack->pushed = 0;
+   idxstack->pulled = 0;
+   idxstack->sendtime = ecx_timing_send(context, groups, ngroups);
+   acyclic = ecx_acyclicpending(context, groups, ngroups);
+   grp = &context->grouplist[groups[0]];
+   /* single group with a frame plan, all decisions are taken */
+   if ((ngroups == 1) && grp->nplan)
+   {
+      if (grp->pimage)
+      {
+         ecx_pimage_fetch(grp->pimage, grp->outputs);
+      }
+      if (grp->dcqual)
+      {
+         ecx_dcqualityrotate(context, groups[0]);
+      }
+      if (!acyclic)
+      {
+         ecx_senddatagrams(context, idxstack, grp->plan, grp->nplan);
+         ecx_stackmarklast(idxstack);
+         return 1;
+      }
+      /* the plan is copied only when acyclic datagrams are appended */
+      n = grp->nplan;
+      memcpy(dg, grp->plan, sizeof(ec_pdatagramt) * n);
+      nreq = ecx_acyclicdatagrams(context, dg, &n, req);
+      ecx_senddatagrams(context, idxstack, dg, n);
+      ecx_acyclicstack(idxstack, req, nreq);
+      ecx_stackmarklast(idxstack);
+      return 1;
+   }
+   for (i = 0; i < ngroups; i++)
+   {
+      grp = &context->grouplist[groups[i]];
+      /* pick up outputs staged by the application */
+      if (grp->pimage)
+      {
+         ecx_pimage_fetch(grp->pimage, grp->outputs);
+      }
+      /* zero copy groups have their own frames */
+      if (grp->zerocopy)
+      {
+         wkc = 1;
+      }
+      else if (ecx_groupdatagrams(context, groups[i], dg, &n))
+      {
+         wkc = 1;
+         if ((dcgroup < 0) && context->grouplist[groups[i]].hasdc)
+         {
+            dcgroup = groups[i];
+         }
+      }
+   }
+   if (dcgroup >= 0)
+   {
+      ecx_dcdatagram(context, (uint8)dcgroup, dg, &n);
+   }
+   if (n)
+   {
+      ecx_layoutdatagrams(dg, n);
+      if (acyclic)
+      {
+         nreq = ecx_acyclicdatagrams(context, dg, &n, req);
+      }
+      ecx_senddatagrams(context, idxstack, dg, n);
+      ecx_acyclicstack(idxstack, req, nreq);
+   }
+   for (i = 0; i < ngroups; i++)
+   {
+      if (context->grouplist[groups[i]].zerocopy)
+      {
+         ecx_zerocopy_send(context, idxstack, groups[i]);
+      }
+   }
+   ecx_stackmarklast(idxstack);
+
+   return wkc;
+}
+
+/** Transmit processdata of several groups to slaves.
+ * The datagrams of all groups are packed together in frames up to the
+ * maximum frame size, see ecx_send_processdata_group(). All datagrams are
+ * recorded on the index stack of the first group in the list, receive with
+ * ecx_receive_processdata_groups() using the same group list.
+ * @param[in]  context        = context struct
+ * @param[in]  groups         = list of group numbers
+ * @param[in]  ngroups        = number of groups in list
+ * @return >0 if processdata is transmitted.
+ */
+int ecx_send_processdata_groups(ecx_contextt *context, const uint8 *groups, int ngroups)
+{
+   if ((ngroups < 1) || (ngroups > EC_MAXGROUPLIST))
+   {
+      return 0;
+   }
+
+   return ecx_send_processdata_stack(context, &context->idxstack[groups[0]], groups, ngroups);
+}
+
+/** Transmit processdata to slaves.
+ * Uses LRW, or LRD/LWR if LRW is not allowed (blockLRW).
+ * Both the input and output processdata are transmitted.
+ * The outputs with the actual data, the inputs have a placeholder.
+ * The inputs are gathered with the receive processdata function.
+ * In contrast to the base LRW function this function is non-blocking.
+ * If the processdata does not fit in one datagram, multiple are used.
+ * Datagrams are packed together in frames up to the maximum frame size,
+ * so f.e. the LRD and LWR of a small blockLRW group go in one frame.
+ * A group with a frame plan is sent as planned, see ecx_frameplan_build().
+ * Queued acyclic datagrams are appended to the last frame, see
+ * ecx_acyclic_attach(). In order to recombine the slave response, a stack is used. Every group
+ * has its own stack, so different groups can be cycled from different
+ * threads.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ * @return >0 if processdata is transmitted.
+ */
+int ecx_send_processdata_group(ecx_contextt *context, uint8 group)
+{
+   return ecx_send_processdata_groups(context, &group, 1);
+}
+
+/** Copy the result of one received datagram back to the process data.
+ * @param[in]  context        = context struct
+ * @param[in]  idxstack       = index stack of group
+ * @param[in]  pos            = stack location of datagram
+ * @return Work counter contribution of the datagram.
+ */
+static int ecx_completedatagram(ecx_contextt *context, ec_idxstackT *idxstack, int pos)
+{
+   ec_groupt *grp;
+   uint8 *rxbuf;
+   uint16 le_wkc;
+   int64 le_DCtime;
+   int wkc = 0;
+
+   rxbuf = context->port->rxbuf[idxstack->idx[pos]] + idxstack->rxoffset[pos];
+   memcpy(&le_wkc, rxbuf + idxstack->length[pos], EC_WKCSIZE);
+   grp = &context->grouplist[idxstack->group[pos]];
+   /* acyclic datagram, does not count in the group work counter */
+   if (idxstack->acyclic[pos])
+   {
+      memcpy(idxstack->data[pos], rxbuf, idxstack->length[pos]);
+      ecx_acyclic_complete(idxstack->acyclic[pos], etohs(le_wkc));
+      return 0;
+   }
+   switch (idxstack->cmd[pos])
+   {
+      case EC_CMD_LRD:
+      case EC_CMD_LRW:
+         /* copy input data back to process data buffer, not for zero copy */
+         if (idxstack->data[pos])
+         {
+            memcpy(idxstack->data[pos], rxbuf, idxstack->length[pos]);
+         }
+         wkc = etohs(le_wkc);
+         /* the AL status read does not count in the group work counter */
+         if (idxstack->data[pos] && (idxstack->data[pos] == grp->status))
+         {
+            grp->statuswkc = wkc;
+            osal_atomic_store(&grp->statusdone, grp->statusdone + 1);
+            wkc = 0;
+         }
+         break;
+      case EC_CMD_LWR:
+         /* output WKC counts 2 times when using LRW, emulate the same for LWR */
+         wkc = etohs(le_wkc) * 2;
+         break;
+      case EC_CMD_FRMW:
+         memcpy(&le_DCtime, rxbuf, sizeof(le_DCtime));
+         *(context->DCtime) = etohll(le_DCtime);
+         break;
+      case EC_CMD_FPRD:
+         /* diagnostics or DC quality read, data and work counter go to the
+          * slave, they do not count in the group work counter */
+         memcpy(idxstack->data[pos], rxbuf, idxstack->length[pos] + EC_WKCSIZE);
+         if (grp->dcqual && ((ec_dcqualt *)idxstack->data[pos] >= grp->dcqual) &&
+             ((ec_dcqualt *)idxstack->data[pos] < (grp->dcqual + grp->dcqualsize)))
+         {
+            ecx_dcquality_sample((ec_dcqualt *)idxstack->data[pos]);
+         }
+         break;
+      default:
+         break;
+   }
+
+   return wkc;
+}
+
+/** Work counter of a group from the completed datagrams on the stack.
+ * @param[in]  idxstack       = index stack of the send
+ * @param[in]  group          = group number
+ * @param[in]  end            = number of stack entries to sum
+ * @return Work counter of the group.
+ */
+static int ecx_stackgroupwkc(const ec_idxstackT *idxstack, uint8 group, int end)
+{
+   int pos, wkc = 0;
+
+   for (pos = 0; pos < end; pos++)
+   {
+      if (idxstack->group[pos] == group)
+      {
+         wkc += idxstack->wkc[pos];
+      }
+   }
+
+   return wkc;
+}
+
+/** Check for completion of a group after one of its datagrams is completed.
+ * With the last datagram of the group on the stack the inputs are published
+ * and the completion hook is called.
+ * @param[in]  context        = context struct
+ * @param[in]  idxstack       = index stack of the send
+ * @param[in]  pos            = stack location of the completed datagram
+ */
+static void ecx_groupdatagramdone(ecx_contextt *context, ec_idxstackT *idxstack, int pos)
+{
+   ec_groupt *grp;
+   uint8 group;
+   int wkc;
+
+   group = idxstack->group[pos];
+   grp = &context->grouplist[group];
+   /* inputs of the datagram are valid with the full work counter */
+   if (grp->fresh && ecx_islogical(idxstack->cmd[pos]) && idxstack->wkc[pos] &&
+       (idxstack->wkc[pos] == grp->freshwkc[idxstack->seq[pos]]))
+   {
+      grp->freshcycle[idxstack->seq[pos]] = grp->rxcycle + 1;
+   }
+   /* not the last datagram of the group */
+   if (!idxstack->grouplast[pos])
+   {
+      return;
+   }
+   grp->rxcycle++;
+   if (grp->timing && idxstack->sendtime)
+   {
+      ecx_timing_complete(grp->timing, idxstack->sendtime);
+   }
+   if (grp->pimage || grp->completehook || grp->safeoutputs)
+   {
+      wkc = ecx_stackgroupwkc(idxstack, group, pos + 1);
+      /* switch to the safe outputs after too many cycles with a low work counter */
+      if (grp->safeoutputs)
+      {
+         if (wkc >= ((grp->outputsWKC * 2) + grp->inputsWKC))
+         {
+            grp->safecount = 0;
+         }
+         else if (!grp->safeactive && (++grp->safecount >= grp->safethreshold))
+         {
+            grp->safeactive = TRUE;
+         }
+      }
+      if (grp->pimage)
+      {
+         ecx_pimage_publish(grp->pimage, grp->inputs, wkc);
+      }
+      if (grp->completehook)
+      {
+         grp->completehook(group, wkc, grp->completearg);
+      }
+   }
+}
+
+/** Complete all datagrams of the frame at the current stack position and
+ * release the frame buffer.
+ * @param[in]  context        = context struct
+ * @param[in]  idxstack       = index stack of group
+ * @param[in]  received       = TRUE if the frame was received, FALSE if lost
+ */
+static void ecx_completeframe(ecx_contextt *context, ec_idxstackT *idxstack, boolean received)
+{
+   int pos, idx, wkc;
+   boolean reserved;
+
+   pos = idxstack->pulled;
+   idx = idxstack->idx[pos];
+   reserved = context->grouplist[idxstack->group[pos]].zerocopy;
+   /* demux all datagrams of this frame */
+   while ((pos < idxstack->pushed) && (idxstack->idx[pos] == idx))
+   {
+      wkc = 0;
+      if (received)
+      {
+         wkc = ecx_completedatagram(context, idxstack, pos);
+      }
+      else if (idxstack->acyclic[pos])
+      {
+         ecx_acyclic_complete(idxstack->acyclic[pos], EC_NOFRAME);
+      }
+      else if (idxstack->cmd[pos] == EC_CMD_FPRD)
+      {
+         /* lost diagnostics read, the slave did not respond */
+         memset((uint8 *)idxstack->data[pos] + idxstack->length[pos], 0, EC_WKCSIZE);
+      }
+      else if (idxstack->data[pos] &&
+               (idxstack->data[pos] == context->grouplist[idxstack->group[pos]].status))
+      {
+         /* lost AL status read, no slave responded */
+         memset(idxstack->data[pos], 0, idxstack->length[pos]);
+         context->grouplist[idxstack->group[pos]].statuswkc = 0;
+         osal_atomic_store(&context->grouplist[idxstack->group[pos]].statusdone,
+                           context->grouplist[idxstack->group[pos]].statusdone + 1);
+      }
+      idxstack->wkc[pos] = wkc;
+      if (!idxstack->acyclic[pos])
+      {
+         ecx_groupdatagramdone(context, idxstack, pos);
+      }
+      pos++;
+   }
+   idxstack->pulled = pos;
+   /* release buffer, zero copy frames stay reserved */
+   if (!reserved)
+   {
+      ecx_setbufstat(context->port, idx, EC_BUF_EMPTY);
+   }
+}
+
+/** Wait for a frame by polling without blocking socket reads, so the
+ * timeout is kept to the polling interval. Unlike ecx_waitinframe() the
+ * buffer is not released when the frame does not arrive, as needed for
+ * zero copy frames.
+ * @param[in]  context        = context struct
+ * @param[in]  idx            = frame index
+ * @param[in]  timeout        = Timeout in us, 0 polls once.
+ * @return Work counter or EC_NOFRAME.
+ */
+static int ecx_pollwaitinframe(ecx_contextt *context, int idx, int timeout)
+{
+   int wkc;
+   osal_timert timer;
+
+   osal_timer_start(&timer, timeout);
+   do
+   {
+      wkc = ecx_pollinframe(context->port, idx);
+   } while ((wkc <= EC_NOFRAME) && !osal_timer_is_expired(&timer));
+
+   return wkc;
+}
+
+/** Wait for the frame at the current stack position and complete it,
+ * received or lost.
+ * @param[in]  context        = context struct
+ * @param[in]  idxstack       = index stack of the send
+ * @param[in]  timeout        = Timeout in us.
+ * @param[in]  polled         = TRUE to wait with non blocking reads only
+ * @return TRUE if the frame was received.
+ */
+static boolean ecx_stackwaitframe(ecx_contextt *context, ec_idxstackT *idxstack, int timeout,
+                                  boolean polled)
+{
+   int idx, wkc;
+   boolean received;
+
+   idx = idxstack->idx[idxstack->pulled];
+   if (polled || context->grouplist[idxstack->group[idxstack->pulled]].zerocopy)
+   {
+      wkc = ecx_pollwaitinframe(context, idx, timeout);
+   }
+   else
+   {
+      wkc = ecx_waitinframe(context->port, idx, timeout);
+   }
+   received = (wkc > EC_NOFRAME);
+   ecx_completeframe(context, idxstack, received);
+
+   return received;
+}
+
+/** Receive the outstanding frames recorded on the given index stack.
+ * @param[in]  context        = context struct
+ * @param[in]  idxstack       = index stack of the send
+ * @param[in]  groups         = list of group numbers
+ * @param[in]  ngroups        = number of groups in list
+ * @param[out] groupwkc       = work counter per group in list, can be NULL
+ * @param[in]  timeout        = Timeout in us.
+ * @return Work counter of all groups together.
+ */
+static int ecx_receive_processdata_stack(ecx_contextt *context, ec_idxstackT *idxstack,
+                                         const uint8 *groups, int ngroups, int *groupwkc,
+                                         int timeout)
+{
+   int i;
+   int wkc = 0, wkc2;
+   int64 start;
+
+   start = ecx_timing_start(context, groups, ngroups);
+   /* read the same number of frames as send */
+   while (idxstack->pulled < idxstack->pushed)
+   {
+      ecx_stackwaitframe(context, idxstack, timeout, FALSE);
+   }
+   for (i = 0; i < ngroups; i++)
+   {
+      wkc2 = ecx_stackgroupwkc(idxstack, groups[i], idxstack->pulled);
+      wkc += wkc2;
+      if (groupwkc)
+      {
+         groupwkc[i] = wkc2;
+      }
+   }
+   if (start)
+   {
+      ecx_timing_receive(context, groups, ngroups, start);
+   }
+
+   return wkc;
+}
+
+/** Receive processdata of several groups from slaves.
+ * Second part from ecx_send_processdata_groups(), the group list must be
+ * the same as used for sending. Frames already completed by
+ * ecx_poll_processdata_groups() are not waited for again.
+ * Received datagrams are recombined with the processdata with help from the stack.
+ * If a datagram contains input processdata it copies it to the processdata structure.
+ * Every group is completed with its last datagram, see ecx_definecompletehook().
+ * @param[in]  context        = context struct
+ * @param[in]  groups         = list of group numbers
+ * @param[in]  ngroups        = number of groups in list
+ * @param[out] groupwkc       = work counter per group in list, can be NULL
+ * @param[in]  timeout        = Timeout in us.
+ * @return Work counter of all groups together.
+ */
+int ecx_receive_processdata_groups(ecx_contextt *context, const uint8 *groups, int ngroups,
+                                   int *groupwkc, int timeout)
+{
+   if ((ngroups < 1) || (ngroups > EC_MAXGROUPLIST))
+   {
+      return 0;
+   }
+
+   return ecx_receive_processdata_stack(context, &context->idxstack[groups[0]], groups,
+                                        ngroups, groupwkc, timeout);
+}
+
+/** Non blocking receive of processdata of several groups.
+ * Processes the frames of the last ecx_send_processdata_groups() that have
+ * arrived, in the order they were sent. Every datagram is completed on its
+ * own, a group is completed with its last datagram, see ecx_definecompletehook().
+ * Call repeatedly until it returns 1, or finish with
+ * ecx_receive_processdata_groups() to time out on lost frames.
+ * @param[in]  context        = context struct
+ * @param[in]  groups         = list of group numbers, as used for sending
+ * @param[in]  ngroups        = number of groups in list
+ * @return 1 if all frames are completed, 0 if frames are outstanding.
+ */
+int ecx_poll_processdata_groups(ecx_contextt *context, const uint8 *groups, int ngroups)
+{
+   int idx;
+   ec_idxstackT *idxstack;
+
+   if ((ngroups < 1) || (ngroups > EC_MAXGROUPLIST))
+   {
+      return 1;
+   }
+   idxstack = &context->idxstack[groups[0]];
+   while (idxstack->pulled < idxstack->pushed)
+   {
+      idx = idxstack->idx[idxstack->pulled];
+      if (ecx_pollinframe(context->port, idx) <= EC_NOFRAME)
+      {
+         return 0;
+      }
+      ecx_completeframe(context, idxstack, TRUE);
+   }
+
+   return 1;
+}
+
+/** Non blocking receive of processdata of one group.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ * @return 1 if all frames are completed, 0 if frames are outstanding.
+ */
+int ecx_poll_processdata_group(ecx_contextt *context, uint8 group)
+{
+   return ecx_poll_processdata_groups(context, &group, 1);
+}
+
+/** Define completion hook of a group. The hook is called from the
+ * receive or poll function when the last datagram of the group arrived,
+ * with the group number, its work counter and the argument.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ * @param[in]  hook           = pointer to hook function, NULL to remove
+ * @param[in]  arg            = argument passed to the hook
+ * @return 1 if defined, 0 if the group is invalid
+ */
+int ecx_definecompletehook(ecx_contextt *context, uint8 group, void *hook, void *arg)
+{
+   if (group >= context->maxgroup)
+   {
+      return 0;
+   }
+   context->grouplist[group].completehook = hook;
+   context->grouplist[group].completearg = arg;
+
+   return 1;
+}
+
+/** Initialise a process data pipeline of a group. A pipeline keeps up to
+ * depth cycles in flight, the next cycle is sent before the responses of
+ * the previous ones are received. Every cycle has its own index stack, the
+ * frames of all cycles in flight must fit in the EC_MAXBUF frame buffers
+ * next to the frames reserved by zero copy groups. Call after the group is
+ * mapped and its options are set, frames of other groups cycled at the
+ * same time are not accounted for.
+ * The outputs are copied into the frames at send, so the application can
+ * write the outputs of the next cycle while earlier cycles are in flight.
+ * Zero copy groups can not be pipelined, their frames are reserved.
+ * @param[out] pipe           = pipeline to initialise
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ * @param[in]  depth          = max. number of cycles in flight, 1..EC_MAXPIPELINE
+ * @return 1 if initialised, 0 if not possible
+ */
+int ecx_pipeline_init(ec_pipelinet *pipe, ecx_contextt *context, uint8 group, int depth)
+{
+   int nframes, reserved, i;
+
+   if ((group >= context->maxgroup) || (depth < 1) || (depth > EC_MAXPIPELINE) ||
+       context->grouplist[group].zerocopy)
+   {
+      return 0;
+   }
+   /* a busy frame buffer would be reused for the next cycle */
+   ecx_frameplan_wirebytes(context, group, &nframes);
+   reserved = 0;
+   for (i = 0; i < context->maxgroup; i++)
+   {
+      if (context->grouplist[i].zerocopy)
+      {
+         reserved += context->grouplist[i].nsegments;
+      }
+   }
+   if (!nframes || (((depth * nframes) + reserved) > EC_MAXBUF))
+   {
+      return 0;
+   }
+   memset(pipe, 0, sizeof(*pipe));
+   pipe->context = context;
+   pipe->group = group;
+   pipe->depth = depth;
+
+   return 1;
+}
+
+/** Send the next cycle of a pipeline, see ecx_send_processdata_group().
+ * @param[in]  pipe           = pipeline
+ * @return Number of the cycle sent, 0 if the pipeline is full or
+ * there is no processdata.
+ */
+uint32 ecx_pipeline_send(ec_pipelinet *pipe)
+{
+   if (pipe->inflight >= pipe->depth)
+   {
+      return 0;
+   }
+   if (!ecx_send_processdata_stack(pipe->context, &pipe->stack[pipe->head], &pipe->group, 1))
+   {
+      return 0;
+   }
+   /* cycle number 0 is never used */
+   pipe->sent++;
+   if (!pipe->sent)
+   {
+      pipe->sent++;
+   }
+   pipe->cycle[pipe->head] = pipe->sent;
+   pipe->head = (pipe->head + 1) % pipe->depth;
+   pipe->inflight++;
+
+   return pipe->sent;
+}
+
+/** Receive the oldest cycle in flight of a pipeline. The inputs in the
+ * IOmap are those of the returned cycle until the next receive.
+ * @param[in]  pipe           = pipeline
+ * @param[out] cycle          = number of the received cycle, 0 if none in flight
+ * @param[in]  timeout        = Timeout in us.
+ * @return Work counter of the cycle, or EC_NOFRAME if no cycle is in flight.
+ */
+int ecx_pipeline_receive(ec_pipelinet *pipe, uint32 *cycle, int timeout)
+{
+   int tail, wkc;
+
+   *cycle = 0;
+   if (!pipe->inflight)
+   {
+      return EC_NOFRAME;
+   }
+   tail = (pipe->head + pipe->depth - pipe->inflight) % pipe->depth;
+   wkc = ecx_receive_processdata_stack(pipe->context, &pipe->stack[tail], &pipe->group, 1,
+                                       NULL, timeout);
+   *cycle = pipe->cycle[tail];
+   pipe->inflight--;
+
+   return wkc;
+}
+
+/** Receive all cycles in flight of a pipeline, f.e. before a state change.
+ * @param[in]  pipe           = pipeline
+ * @param[in]  timeout        = Timeout in us per cycle.
+ * @return Number of the last received cycle, 0 if none was in flight.
+ */
+uint32 ecx_pipeline_flush(ec_pipelinet *pipe, int timeout)
+{
+   uint32 cycle, last = 0;
+
+   while (pipe->inflight)
+   {
+      ecx_pipeline_receive(pipe, &cycle, timeout);
+      last = cycle;
+   }
+
+   return last;
+}
+
+/* move a process data pointer between two buffers of the same segment */
+static void ecx_zerocopy_move(uint8 **ptr, uint8 *from, uint8 *to, uint32 length)
+{
+   if (*ptr && (*ptr >= from) && (*ptr < (from + length)))
+   {
+      *ptr = to + (*ptr - from);
+   }
+}
+
+/** Switch a group to zero copy process data. Every IO segment gets a
+ * reserved frame buffer that is built once. The output pointers of the
+ * slaves are moved into the transmit frames and the input pointers into the
+ * receive frames, so the application reads and writes the live frame memory
+ * and send / receive only rewrite the work counters. Call after mapping,
+ * the current IOmap content is the initial image. Only for groups that can
+ * use LRW and without buffered process image. One frame buffer per segment
+ * is taken from the port, at most half of them.
+ * The IOmap is no longer sent or received, so the outputs and inputs of
+ * the group, and for group 0 those of the master record slavelist[0], are
+ * set to NULL until ecx_zerocopy_detach(). Use the slave pointers only.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ * @return 1 if switched, 0 if not possible
+ */
+int ecx_zerocopy_attach(ecx_contextt *context, uint8 group)
+{
+   ec_groupt *grp;
+   uint8 *data, *idata, *txdata, *rxdata;
+   uint32 LogAdr, length;
+   uint16 seg, sublength, slave;
+   uint8 idx;
+
+   if (group >= context->maxgroup)
+   {
+      return 0;
+   }
+   grp = &context->grouplist[group];
+   if (grp->zerocopy || grp->blockLRW || grp->pimage || grp->diag || grp->fresh ||
+       grp->safeoutputs || grp->cyclicstatus || grp->dcqual ||
+       !(grp->Obytes + grp->Ibytes) || (grp->nsegments > (EC_MAXBUF / 2)))
+   {
+      return 0;
+   }
+   /* without overlap the image is outputs followed by inputs */
+   length = grp->overlap ? grp->Obytes : (grp->Obytes + grp->Ibytes);
+   data = grp->Obytes ? grp->outputs : grp->inputs;
+   idata = grp->overlap ? grp->inputs : data;
+   LogAdr = grp->logstartaddr;
+   grp->zcdcoffset = 0;
+   for (seg = 0; (seg < grp->nsegments) && length; seg++)
+   {
+      sublength = (uint16)grp->IOsegment[seg];
+      idx = (uint8)ecx_getindex(context->port);
+      grp->zcidx[seg] = idx;
+      ecx_setupdatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_LRW, idx,
+                        LO_WORD(LogAdr), HI_WORD(LogAdr), sublength, data);
+      if (!seg && grp->hasdc)
+      {
+         /* FRMW of DC time in the room reserved in the first segment */
+         grp->zcdcoffset = ecx_adddatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_FRMW,
+                                           idx, FALSE, context->slavelist[grp->DCnext].configadr,
+                                           ECT_REG_DCSYSTIME, sizeof(int64), context->DCtime);
+      }
+      txdata = (uint8 *)&(context->port->txbuf[idx]) + ETH_HEADERSIZE + EC_HEADERSIZE;
+      rxdata = (uint8 *)&(context->port->rxbuf[idx]) + EC_HEADERSIZE;
+      memcpy(rxdata, idata, sublength);
+      for (slave = 1; slave <= *(context->slavecount); slave++)
+      {
+         if (!group || (group == context->slavelist[slave].group))
+         {
+            ecx_zerocopy_move(&context->slavelist[slave].outputs, data, txdata, sublength);
+            ecx_zerocopy_move(&context->slavelist[slave].inputs, idata, rxdata, sublength);
+         }
+      }
+      LogAdr += sublength;
+      length -= sublength;
+      data += sublength;
+      idata += sublength;
+   }
+   /* the IOmap is dead while zero copy, keep it for the detach only */
+   grp->zcoutputs = grp->outputs;
+   grp->zcinputs = grp->inputs;
+   grp->outputs = NULL;
+   grp->inputs = NULL;
+   if (!group)
+   {
+      context->slavelist[0].outputs = NULL;
+      context->slavelist[0].inputs = NULL;
+   }
+   grp->zerocopy = TRUE;
+   grp->nplan = 0;
+
+   return 1;
+}
+
+/** Switch a group back from zero copy process data. The live data is
+ * copied back to the IOmap and the frame buffers are released. Must not
+ * run concurrently with send or receive of the group.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ */
+void ecx_zerocopy_detach(ecx_contextt *context, uint8 group)
+{
+   ec_groupt *grp;
+   uint8 *data, *idata, *txdata, *rxdata;
+   uint32 offset, length;
+   uint16 seg, sublength, slave;
+   uint8 idx;
+
+   if ((group >= context->maxgroup) || !context->grouplist[group].zerocopy)
+   {
+      return;
+   }
+   grp = &context->grouplist[group];
+   grp->outputs = grp->zcoutputs;
+   grp->inputs = grp->zcinputs;
+   if (!group)
+   {
+      context->slavelist[0].outputs = grp->outputs;
+      context->slavelist[0].inputs = grp->inputs;
+   }
+   length = grp->overlap ? grp->Obytes : (grp->Obytes + grp->Ibytes);
+   data = grp->Obytes ? grp->outputs : grp->inputs;
+   idata = grp->overlap ? grp->inputs : data;
+   offset = 0;
+   for (seg = 0; (seg < grp->nsegments) && (offset < length); seg++)
+   {
+      sublength = (uint16)grp->IOsegment[seg];
+      idx = grp->zcidx[seg];
+      txdata = (uint8 *)&(context->port->txbuf[idx]) + ETH_HEADERSIZE + EC_HEADERSIZE;
+      rxdata = (uint8 *)&(context->port->rxbuf[idx]) + EC_HEADERSIZE;
+      if (grp->overlap)
+      {
+         memcpy(data + offset, txdata, sublength);
+         memcpy(idata + offset, rxdata, sublength);
+      }
+      else
+      {
+         /* outputs part from the transmit frame, inputs part from the receive frame */
+         memcpy(data + offset, rxdata, sublength);
+         if (offset < grp->Obytes)
+         {
+            memcpy(data + offset, txdata,
+                   ((grp->Obytes - offset) < sublength) ? (grp->Obytes - offset) : sublength);
+         }
+      }
+      for (slave = 1; slave <= *(context->slavecount); slave++)
+      {
+         if (!group || (group == context->slavelist[slave].group))
+         {
+            ecx_zerocopy_move(&context->slavelist[slave].outputs, txdata, data + offset, sublength);
+            ecx_zerocopy_move(&context->slavelist[slave].inputs, rxdata, idata + offset, sublength);
+         }
+      }
+      ecx_setbufstat(context->port, idx, EC_BUF_EMPTY);
+      offset += sublength;
+   }
+   grp->zerocopy = FALSE;
+   ecx_frameplan_build(context, group);
+}
+
+/** Receive processdata of a group with one deadline for all its frames.
+ * Second part from ecx_send_processdata_group(). Frames are waited for in
+ * send order as long as the deadline allows, frames that have not arrived
+ * by then are completed as lost and their inputs keep the previous values.
+ * So one lost frame costs the time up to the deadline and not a timeout per
+ * frame.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ * @param[in]  deadline       = absolute deadline in ns, see osal_current_time_ns()
+ * @param[out] result         = completion per datagram and slack, can be NULL
+ * @return Work counter of the completed datagrams.
+ */
+int ecx_receive_processdata_deadline(ecx_contextt *context, uint8 group, int64 deadline,
+                                     ec_rxresultt *result)
+{
+   ec_idxstackT *idxstack;
+   int64 now, start;
+   int pos, timeout, wkc;
+   boolean received;
+
+   idxstack = &context->idxstack[group];
+   start = ecx_timing_start(context, &group, 1);
+   if (result)
+   {
+      memset(result, 0, sizeof(ec_rxresultt));
+      result->ndatagram = idxstack->pushed;
+   }
+   while (idxstack->pulled < idxstack->pushed)
+   {
+      /* past the deadline the frames are still polled once */
+      now = osal_current_time_ns();
+      timeout = (now < deadline) ? (int)((deadline - now) / 1000) : 0;
+      pos = idxstack->pulled;
+      received = ecx_stackwaitframe(context, idxstack, timeout, TRUE);
+      if (result && received)
+      {
+         for (; pos < idxstack->pulled; pos++)
+         {
+            result->complete[pos] = TRUE;
+            result->ncomplete++;
+         }
+      }
+   }
+   wkc = ecx_stackgroupwkc(idxstack, group, idxstack->pulled);
+   if (start)
+   {
+      ecx_timing_receive(context, &group, 1, start);
+   }
+   if (result)
+   {
+      result->wkc = wkc;
+      result->slack = deadline - osal_current_time_ns();
+   }
+
+   return wkc;
+}
+
+/** Receive processdata from slaves.
+ * Second part from ec_send_processdata().
+ * Received datagrams are recombined with the processdata with help from the stack.
+ * If a datagram contains input processdata it copies it to the processdata structure.
+ * @param[in]  context        = context struct
+ * @param[in]  group          = group number
+ * @param[in]  timeout        = Timeout in us.
+ * @return Work counter.
+ */
+int ecx_receive_processdata_group(ecx_contextt *context, uint8 group, int timeout)
+{
+   return ecx_receive_processdata_groups(context, &group, 1, NULL, timeout);
+}
+
 
 int ecx_send_processdata(ecx_contextt *context)
 {
@@ -1807,6 +4089,170 @@ int ecx_receive_processdata(ecx_contextt *context, int timeout)
    return ecx_receive_processdata_group(context, 0, timeout);
 }
 
+/** Clear histogram and set bin width.
+ * @param[out] hist       = histogram
+ * @param[in]  binwidth   = width of one bin in ns, EC_HISTLOG for log scale
+ */
+void ec_hist_init(ec_histt *hist, int32 binwidth)
+{
+   memset(hist, 0, sizeof(ec_histt));
+   hist->binwidth = (binwidth >= 0) ? binwidth : 1;
+}
+
+/** Bin of a sample in a log scale histogram. Values below 4 have a bin
+ * each, above that every power of two is split in 4 bins.
+ * @param[in]  value      = sample in ns
+ * @return bin number
+ */
+static int ec_hist_logbin(int64 value)
+{
+   uint64 v;
+   int shift, msb = 0;
+
+   if (value < 4)
+   {
+      return (value > 0) ? (int)value : 0;
+   }
+   /* binary search of the most significant bit */
+   v = (uint64)value;
+   for (shift = 32; shift; shift >>= 1)
+   {
+      if (v >> shift)
+      {
+         msb += shift;
+         v >>= shift;
+      }
+   }
+   if (msb > 32)
+   {
+      return EC_HISTBINS - 1;
+   }
+
+   return ((msb - 1) << 2) + (int)((value >> (msb - 2)) & 3);
+}
+
+/** Upper limit of a histogram bin.
+ * @param[in]  hist       = histogram
+ * @param[in]  bin        = bin number
+ * @return first value above the bin in ns
+ */
+static int64 ec_hist_binlimit(const ec_histt *hist, int bin)
+{
+   if (hist->binwidth != EC_HISTLOG)
+   {
+      return (int64)(bin + 1) * hist->binwidth;
+   }
+   if (bin < 4)
+   {
+      return bin + 1;
+   }
+
+   return (int64)(5 + (bin & 3)) << ((bin >> 2) - 1);
+}
+
+/** Add sample to histogram. Negative values go to the first bin,
+ * values beyond the range to the last bin.
+ * @param[in,out] hist    = histogram
+ * @param[in]  value      = sample in ns
+ */
+void ec_hist_add(ec_histt *hist, int64 value)
+{
+   int64 bin;
+
+   if (hist->binwidth == EC_HISTLOG)
+   {
+      bin = ec_hist_logbin(value);
+   }
+   else
+   {
+      bin = value / hist->binwidth;
+   }
+   if (bin < 0)
+   {
+      bin = 0;
+   }
+   if (bin >= EC_HISTBINS)
+   {
+      bin = EC_HISTBINS - 1;
+   }
+   hist->bin[bin]++;
+   if (!hist->count || (value < hist->min))
+   {
+      hist->min = value;
+   }
+   if (!hist->count || (value > hist->max))
+   {
+      hist->max = value;
+   }
+   hist->count++;
+   hist->sum += value;
+}
+
+/** Percentile of the samples in a histogram. The result is the upper limit
+ * of the bin the percentile falls in, kept within the smallest and largest
+ * sample.
+ * @param[in]  hist       = histogram
+ * @param[in]  ppm        = percentile in parts per million, f.e. 990000 for p99
+ * @return percentile in ns, 0 if the histogram is empty
+ */
+int64 ec_hist_percentile(const ec_histt *hist, uint32 ppm)
+{
+   uint64 target, sum;
+   int64 limit;
+   int bin;
+
+   if (!hist->count)
+   {
+      return 0;
+   }
+   target = ((uint64)hist->count * ppm + 999999) / 1000000;
+   if (!target)
+   {
+      target = 1;
+   }
+   sum = 0;
+   for (bin = 0; bin < (EC_HISTBINS - 1); bin++)
+   {
+      sum += hist->bin[bin];
+      if (sum >= target)
+      {
+         limit = ec_hist_binlimit(hist, bin);
+         if (limit > hist->max)
+         {
+            limit = hist->max;
+         }
+         if (limit < hist->min)
+         {
+            limit = hist->min;
+         }
+         return limit;
+      }
+   }
+
+   /* overflow bin */
+   return hist->max;
+}
+
+/** Summarize histogram in count, min, mean, p50, p99, p99.9 and max.
+ * @param[in]  hist       = histogram
+ * @param[out] snap       = summary
+ */
+void ec_hist_snapshot(const ec_histt *hist, ec_histsnapt *snap)
+{
+   memset(snap, 0, sizeof(ec_histsnapt));
+   if (!hist->count)
+   {
+      return;
+   }
+   snap->count = hist->count;
+   snap->min = hist->min;
+   snap->max = hist->max;
+   snap->mean = hist->sum / hist->count;
+   snap->p50 = ec_hist_percentile(hist, 500000);
+   snap->p99 = ec_hist_percentile(hist, 990000);
+   snap->p999 = ec_hist_percentile(hist, 999000);
+}
+
 #ifdef EC_VER1
 void ec_pusherror(const ec_errort *Ec)
 {
@@ -1994,6 +4440,146 @@ int ec_receive_processdata_group(uint8 group, int timeout)
    return ecx_receive_processdata_group (&ecx_context, group, timeout);
 }
 
+int ec_receive_processdata_deadline(uint8 group, int64 deadline, ec_rxresultt *result)
+{
+   return ecx_receive_processdata_deadline(&ecx_context, group, deadline, result);
+}
+
+int ec_send_processdata_groups(const uint8 *groups, int ngroups)
+{
+   return ecx_send_processdata_groups (&ecx_context, groups, ngroups);
+}
+
+int ec_receive_processdata_groups(const uint8 *groups, int ngroups, int *groupwkc, int timeout)
+{
+   return ecx_receive_processdata_groups (&ecx_context, groups, ngroups, groupwkc, timeout);
+}
+
+int ec_poll_processdata_group(uint8 group)
+{
+   return ecx_poll_processdata_group (&ecx_context, group);
+}
+
+int ec_poll_processdata_groups(const uint8 *groups, int ngroups)
+{
+   return ecx_poll_processdata_groups (&ecx_context, groups, ngroups);
+}
+
+int ec_definecompletehook(uint8 group, void *hook, void *arg)
+{
+   return ecx_definecompletehook (&ecx_context, group, hook, arg);
+}
+
+int ec_zerocopy_attach(uint8 group)
+{
+   return ecx_zerocopy_attach (&ecx_context, group);
+}
+
+void ec_zerocopy_detach(uint8 group)
+{
+   ecx_zerocopy_detach (&ecx_context, group);
+}
+
+int ec_pipeline_init(ec_pipelinet *pipe, uint8 group, int depth)
+{
+   return ecx_pipeline_init(pipe, &ecx_context, group, depth);
+}
+
+int ec_frameplan_build(uint8 group)
+{
+   return ecx_frameplan_build(&ecx_context, group);
+}
+
+int ec_frameplan_wirebytes(uint8 group, int *nframes)
+{
+   return ecx_frameplan_wirebytes(&ecx_context, group, nframes);
+}
+
+int ec_diag_enable(uint8 group, boolean enable)
+{
+   return ecx_diag_enable(&ecx_context, group, enable);
+}
+
+uint16 ec_diag_check(uint8 group)
+{
+   return ecx_diag_check(&ecx_context, group);
+}
+
+int ec_fresh_enable(uint8 group, boolean enable)
+{
+   return ecx_fresh_enable(&ecx_context, group, enable);
+}
+
+int32 ec_fresh_age(uint8 group, uint16 slave)
+{
+   return ecx_fresh_age(&ecx_context, group, slave);
+}
+
+int ec_safe_attach(uint8 group, uint8 *safe, uint32 size, uint16 threshold)
+{
+   return ecx_safe_attach(&ecx_context, group, safe, size, threshold);
+}
+
+void ec_safe_detach(uint8 group)
+{
+   ecx_safe_detach(&ecx_context, group);
+}
+
+void ec_safe_release(uint8 group)
+{
+   ecx_safe_release(&ecx_context, group);
+}
+
+int ec_statusmap_cyclic(uint8 group, boolean enable)
+{
+   return ecx_statusmap_cyclic(&ecx_context, group, enable);
+}
+
+int ec_statusmap_read(uint8 group, int timeout)
+{
+   return ecx_statusmap_read(&ecx_context, group, timeout);
+}
+
+uint16 ec_statusmap_check(uint8 group)
+{
+   return ecx_statusmap_check(&ecx_context, group);
+}
+
+int ec_acyclic_attach(uint8 group, ec_acyclicqt *queue)
+{
+   return ecx_acyclic_attach(&ecx_context, group, queue);
+}
+
+void ec_acyclic_detach(void)
+{
+   ecx_acyclic_detach(&ecx_context);
+}
+
+int ec_acyclic_post(ec_acyclict *req)
+{
+   return ecx_acyclic_post(&ecx_context, req);
+}
+
+int ec_acyclic_wait(ec_acyclict *req, int timeout)
+{
+   return ecx_acyclic_wait(&ecx_context, req, timeout);
+}
+
+const ec_pdoentryt *ec_pdo_entry(uint16 slave, uint16 n)
+{
+   return ecx_pdo_entry(&ecx_context, slave, n);
+}
+
+int ec_pdo_find(uint16 slave, uint16 index, uint8 subindex, ec_pdovart *var)
+{
+   return ecx_pdo_find(&ecx_context, slave, index, subindex, var);
+}
+
+int ec_pdo_findname(uint16 slave, const char *name, ec_pdovart *var)
+{
+   return ecx_pdo_findname(&ecx_context, slave, name, var);
+}
+
 int ec_send_processdata(void)
 {
    return ec_send_processdata_group(0);
@@ -58,10 +58,29 @@ extern "C"
 #define EC_MAXNAME        40
 /** max. number of slaves in array */
 #define EC_MAXSLAVE       200
-/** max. number of groups */
+/** max. number of groups, override for more groups in the static context */
+#ifndef EC_MAXGROUP
 #define EC_MAXGROUP       2
+#endif
 /** max. number of IO segments per group */
 #define EC_MAXIOSEGMENTS  64
+/** max. number of process data datagrams in flight, override for per slave
+ * diagnostics of large groups, max. 255 */
+#ifndef EC_MAXIDXSTACK
+#define EC_MAXIDXSTACK    64
+#endif
+/** max. number of groups sent together, group numbers are uint8 */
+#define EC_MAXGROUPLIST   256
+/** max. number of cycles in flight in a process data pipeline */
+#define EC_MAXPIPELINE    4
+/** max. number of queued acyclic datagrams, power of two */
+#ifndef EC_MAXACYCLIC
+#define EC_MAXACYCLIC     16
+#endif
+/** max. number of PDO entries of all slaves in the static context */
+#ifndef EC_MAXPDOENTRY
+#define EC_MAXPDOENTRY    1024
+#endif
 /** max. mailbox size */
 #define EC_MAXMBX         0x3ff
 /** max. eeprom PDO entries */
@@ -72,6 +91,10 @@ extern "C"
 #define EC_MAXFMMU        4
 /** max. Adapter */
 #define EC_MAXLEN_ADAPTERNAME    128
+/** default poll interval in us for state change check */
+#define EC_STATEPOLLDELAY  1000
+/** default poll interval in us for mailbox status */
+#define EC_MBXPOLLDELAY    200
 
 typedef struct ec_adapter ec_adaptert;
 struct ec_adapter
@@ -81,6 +104,33 @@ struct ec_adapter
    ec_adaptert *next;
 };
 
+/** process data datagram, entry of a frame plan */
+typedef struct
+{
+   /** datagram command */
+   uint8    cmd;
+   /** address position / logical address low word */
+   uint16   ADP;
+   /** address offset / logical address high word */
+   uint16   ADO;
+   /** data length */
+   uint16   length;
+   /** process data transmitted */
+   void     *data;
+   /** process data the response is copied to */
+   void     *rxdata;
+   /** bytes at the start of the response not copied back */
+   uint16   rxskip;
+   /** offset of datagram data in rx frame, EC_HEADERSIZE starts a new frame */
+   uint16   rxoffset;
+   /** TRUE if another datagram follows in the same frame */
+   boolean  more;
+   /** group the datagram belongs to */
+   uint8    group;
+   /** number of the LRD/LWR/LRW datagram within its group */
+   uint8    seq;
+} ec_pdatagramt;
+
 /** record for FMMU */
 PACKED_BEGIN
 typedef struct PACKED
@@ -256,14 +306,41 @@ typedef struct
    uint8            group;
    /** first unused FMMU */
    uint8            FMMUunused;
+   /** logical bytes the outputs of the slave add to the group, in overlap
+    * mode inputs and outputs together, see ecx_config_segment() */
+   uint32           Ologsize;
+   /** logical bytes the inputs of the slave add to the group */
+   uint32           Ilogsize;
    /** TRUE is slave is not responding at all */
    boolean          islost;
    /** registered configuration function PO->SO */
    int              (*PO2SOconfig)(uint16 slave);
    /** readable name */
    char             name[EC_MAXNAME + 1];
+   /** internal, AL status, reserved, AL status code and work counter of the
+    * cyclic diagnostics read, see ecx_diag_enable(). EtherCAT byte order */
+   uint16           diagbuf[4];
+   /** first entry of the slave in the PDO entry table */
+   uint16           pdoentry;
+   /** number of PDO entries of the slave */
+   uint16           npdoentry;
+   /** AL status register mapped in the IOmap, EtherCAT byte order, NULL if
+    * not mapped. See ec_groupt mapstatus */
+   uint8            *alstatus;
+   /** SM1 status register mapped in the IOmap, NULL if not mapped. See
+    * ec_groupt mapmbxstatus */
+   uint8            *mbxstatus;
+   /** first process data datagram of the group carrying inputs of the
+    * slave, see ecx_fresh_enable() */
+   uint8            freshseq;
+   /** number of datagrams carrying inputs of the slave, 0 = not tracked */
+   uint8            nfreshseq;
 } ec_slavet;
 
+struct ec_pimage;
+struct ec_timing;
+struct ec_dcqual;
+
 /** for list of ethercat slave groups */
 typedef struct
 {
@@ -297,8 +374,85 @@ typedef struct
    uint16           inputsWKC;
    /** check slave states */
    boolean          docheckstate;
+   /** inputs share the logical range of the outputs, see ecx_config_overlap_map_group() */
+   boolean          overlap;
+   /** read the AL status of every slave with the process data, see ecx_diag_enable() */
+   boolean          diag;
+   /** track the input age per slave, see ecx_fresh_enable() */
+   boolean          fresh;
+   /** TRUE while the safe outputs are sent, see ecx_safe_attach() */
+   volatile boolean safeactive;
+   /** map the AL status of every slave with a spare FMMU, set before mapping
+    * the group, see ecx_statusmap_read() */
+   boolean          mapstatus;
+   /** map the SM1 status of every mailbox slave with a spare FMMU, set before
+    * mapping the group, see ecx_mbxreceive() */
+   boolean          mapmbxstatus;
+   /** balance the IO segment sizes, set before mapping the group, see
+    * ecx_config_segment() */
+   boolean          balancesegments;
+   /** read the mapped status with the process data, see ecx_statusmap_cyclic() */
+   boolean          cyclicstatus;
+   /** process data lives in reserved frame buffers, see ecx_zerocopy_attach() */
+   boolean          zerocopy;
+   /** internal, frame index reserved per IO segment in zero copy mode */
+   uint8            zcidx[EC_MAXIOSEGMENTS];
+   /** internal, offset of the DC datagram in the first zero copy frame, 0 = none */
+   uint16           zcdcoffset;
+   /** internal, IOmap outputs while zero copy, outputs is NULL then */
+   uint8            *zcoutputs;
+   /** internal, IOmap inputs while zero copy, inputs is NULL then */
+   uint8            *zcinputs;
    /** IO segmentation list. Datagrams must not break SM in two. */
    uint32           IOsegment[EC_MAXIOSEGMENTS];
+   /** buffered process image, NULL if the IOmap is used directly */
+   struct ec_pimage *pimage;
+   /** called when all datagrams of the group of a send are received, can be NULL */
+   void             (*completehook)(uint8 group, int wkc, void *arg);
+   /** argument passed to the completion hook */
+   void             *completearg;
+   /** process data timing, NULL if not timed, see ecx_timing_attach() */
+   struct ec_timing *timing;
+   /** DC sync quality table indexed by slave, NULL = not monitored, see
+    * ecx_dcquality_attach() */
+   struct ec_dcqual *dcqual;
+   /** number of entries in the DC sync quality table */
+   uint16           dcqualsize;
+   /** number of DC slaves read per send */
+   uint16           dcqualsubset;
+   /** internal, last DC slave read */
+   uint16           dcqualnext;
+   /** number of datagrams in the frame plan, 0 = build the datagrams every send */
+   uint16           nplan;
+   /** frame plan, datagrams and frame layout of a send, see ecx_frameplan_build() */
+   ec_pdatagramt    plan[EC_MAXIDXSTACK];
+   /** number of completed receive cycles of the group */
+   uint32           rxcycle;
+   /** expected work counter per process data datagram of the group */
+   uint16           freshwkc[EC_MAXIDXSTACK];
+   /** last receive cycle per process data datagram with a full work counter */
+   uint32           freshcycle[EC_MAXIDXSTACK];
+   /** safe output image sent after communication loss, NULL = none */
+   uint8            *safeoutputs;
+   /** cycles with a low work counter until the safe outputs are sent */
+   uint16           safethreshold;
+   /** internal, cycles with a low work counter in a row */
+   uint16           safecount;
+   /** logical start address of the status area */
+   uint32           statuslogaddr;
+   /** size of the status area, 2 bytes per mapped AL status and 1 byte per
+    * mapped SM1 status, 0 = not mapped */
+   uint16           statusbytes;
+   /** expected work counter of the status read, one per mapped slave */
+   uint16           statusWKC;
+   /** work counter of the last status read */
+   int              statuswkc;
+   /** internal, number of status reads sent */
+   uint32           statussent;
+   /** internal, number of status reads completed or lost, in send order */
+   uint32           statusdone;
+   /** status area in the IOmap, followed by as many zero bytes sent by the read */
+   uint8            *status;
 } ec_groupt;
 
 /** SII FMMU structure */
@@ -361,16 +515,94 @@ typedef struct PACKED
 } ec_alstatust;
 PACKED_END
 
-/** stack structure to store segmented LRD/LWR/LRW constructs */
+/** stack structure to store segmented LRD/LWR/LRW constructs.
+ * One entry per datagram, datagrams packed in the same frame share
+ * the frame index and are pushed consecutively. */
 typedef struct
 {
    uint8   pushed;
    uint8   pulled;
-   uint8   idx[EC_MAXBUF];
-   void    *data[EC_MAXBUF];
-   uint16  length[EC_MAXBUF];
+   /** frame index */
+   uint8   idx[EC_MAXIDXSTACK];
+   /** process data pointer of datagram */
+   void    *data[EC_MAXIDXSTACK];
+   /** data length of datagram */
+   uint16  length[EC_MAXIDXSTACK];
+   /** offset of datagram data in rx frame */
+   uint16  rxoffset[EC_MAXIDXSTACK];
+   /** datagram command */
+   uint8   cmd[EC_MAXIDXSTACK];
+   /** group the datagram belongs to */
+   uint8   group[EC_MAXIDXSTACK];
+   /** number of the LRD/LWR/LRW datagram within its group */
+   uint8   seq[EC_MAXIDXSTACK];
+   /** work counter of completed datagram */
+   int     wkc[EC_MAXIDXSTACK];
+   /** acyclic request of the datagram, NULL for process data */
+   struct ec_acyclic *acyclic[EC_MAXIDXSTACK];
+   /** datagram is the last of its group on the stack */
+   boolean grouplast[EC_MAXIDXSTACK];
+   /** time of the send in ns, 0 if not timed */
+   int64   sendtime;
 } ec_idxstackT;
 
+/** Result of a receive with deadline, see ecx_receive_processdata_deadline() */
+typedef struct
+{
+   /** work counter of the completed datagrams */
+   int     wkc;
+   /** number of datagrams of the send */
+   int     ndatagram;
+   /** number of datagrams completed before the deadline */
+   int     ncomplete;
+   /** per datagram, TRUE if completed. Same order as the index stack of
+    * the group, which holds data pointer, length and command of each. */
+   boolean complete[EC_MAXIDXSTACK];
+   /** time left until the deadline in ns, negative when overrun */
+   int64   slack;
+} ec_rxresultt;
+
+/** acyclic request states */
+#define EC_ACYCLIC_IDLE    0
+#define EC_ACYCLIC_QUEUED  1
+#define EC_ACYCLIC_SENT    2
+#define EC_ACYCLIC_DONE    3
+
+/** Acyclic datagram sent in the last frame of the process data, see
+ * ecx_acyclic_post(). The request and its data must stay valid until it is
+ * done. */
+typedef struct ec_acyclic
+{
+   /** datagram command, f.e. EC_CMD_FPRD */
+   uint8           cmd;
+   /** address position */
+   uint16          ADP;
+   /** address offset */
+   uint16          ADO;
+   /** data length */
+   uint16          length;
+   /** data sent, replaced by the response */
+   void            *data;
+   /** work counter of the response, EC_NOFRAME if the frame was lost */
+   int             wkc;
+   /** internal, EC_ACYCLIC_ state */
+   volatile uint32 state;
+} ec_acyclict;
+
+/** Queue of acyclic datagrams for the process data of a group, see
+ * ecx_acyclic_attach(). Any thread can post, the send of the group takes. */
+typedef struct
+{
+   /** group whose sends carry the queued datagrams */
+   uint8           group;
+   /** internal, posted requests */
+   osal_ringt      ring;
+   /** internal, request taken from the ring that did not fit the last frame */
+   ec_acyclict     *carry;
+   /** internal, ring buffer */
+   uint8           buf[OSAL_MPSC_BUFSIZE(EC_MAXACYCLIC, sizeof(ec_acyclict *))];
+} ec_acyclicqt;
+
 /** ringbuf for error storage */
 typedef struct 
 {
@@ -409,6 +641,40 @@ typedef struct PACKED
 } ec_PDOdesct;   
 PACKED_END
 
+/** PDO entry, one object mapped in the process data of a slave */
+typedef struct
+{
+   /** object index, 0 for a gap */
+   uint16  index;
+   /** object subindex */
+   uint8   subindex;
+   /** SyncManager the entry is mapped by */
+   uint8   sm;
+   /** data type, f.e. ECT_UNSIGNED16, 0 if unknown */
+   uint16  datatype;
+   /** bit length */
+   uint16  bitlen;
+   /** bit offset from the start of the slave inputs or outputs */
+   uint32  bitoffset;
+   /** SII string number of the entry name, 0 if unknown */
+   uint8   name;
+   /** TRUE for outputs (RxPDO), FALSE for inputs (TxPDO) */
+   boolean output;
+} ec_pdoentryt;
+
+/** Process variable resolved to the IOmap, see ecx_pdo_find() */
+typedef struct
+{
+   /** first byte of the variable */
+   uint8   *data;
+   /** bit position in the first byte */
+   uint8   bit;
+   /** bit length */
+   uint16  bitlen;
+   /** data type, f.e. ECT_UNSIGNED16, 0 if unknown */
+   uint16  datatype;
+} ec_pdovart;
+
 /** Context structure , referenced by all ecx functions*/
 typedef struct
 {
@@ -432,14 +698,10 @@ typedef struct
    uint16         esislave;
    /** internal, reference to error list */
    ec_eringt      *elist;
-   /** internal, reference to processdata stack buffer info */
+   /** internal, reference to processdata stack buffer info, one per group */
    ec_idxstackT   *idxstack;
    /** reference to ecaterror state */
    boolean        *ecaterror;
-   /** internal, position of DC datagram in process data packet */
-   uint16         DCtO;
-   /** internal, length of DC datagram */
-   uint16         DCl;
    /** reference to last DC time from slaves */
    int64          *DCtime;
    /** internal, SM buffer */
@@ -454,8 +716,61 @@ typedef struct
    ec_eepromFMMUt *eepFMMU; 
    /** registered FoE hook */
    int            (*FOEhook)(uint16 slave, int packetnumber, int datasize);
+   /** poll interval in us of ecx_statecheck, 0 = EC_STATEPOLLDELAY */
+   uint32         statepolldelay;
+   /** poll interval in us of mailbox status, 0 = EC_MBXPOLLDELAY */
+   uint32         mbxpolldelay;
+   /** PDO entry table of all slaves */
+   ec_pdoentryt   *pdoentry;
+   /** size of PDO entry table */
+   int            maxpdoentry;
+   /** number of used entries in PDO entry table */
+   int            npdoentry;
+   /** internal, slave whose PDO entries are recorded, 0 = none */
+   uint16         pdoslave;
+   /** acyclic datagram queue, NULL = none, see ecx_acyclic_attach() */
+   ec_acyclicqt   *acyclicq;
 } ecx_contextt;
 
+/** Parameters for ecx_context_create() */
+typedef struct
+{
+   /** size of slavelist including master entry 0, 0 = EC_MAXSLAVE */
+   int            maxslave;
+   /** size of grouplist, 0 = EC_MAXGROUP */
+   int            maxgroup;
+   /** size of PDO entry table, 0 = EC_MAXPDOENTRY */
+   int            maxpdoentry;
+   /** also allocate the port for redundant operation */
+   boolean        redundant;
+   /** try to place the arena in huge pages */
+   boolean        hugepages;
+   /** touch all arena memory at creation */
+   boolean        prefault;
+} ecx_contextparamt;
+
+/** Process data pipeline of a group, see ecx_pipeline_init().
+ * Every cycle in flight has its own index stack. */
+typedef struct
+{
+   /** context the group belongs to */
+   ecx_contextt   *context;
+   /** group number */
+   uint8          group;
+   /** max. number of cycles in flight */
+   int            depth;
+   /** number of cycles in flight */
+   int            inflight;
+   /** stack of the next cycle to send */
+   int            head;
+   /** number of the last cycle sent */
+   uint32         sent;
+   /** cycle number per stack */
+   uint32         cycle[EC_MAXPIPELINE];
+   /** index stack per cycle in flight */
+   ec_idxstackT   stack[EC_MAXPIPELINE];
+} ec_pipelinet;
+
 #ifdef EC_VER1
 /** global struct to hold default master context */
 extern ecx_contextt  ecx_context;
@@ -501,6 +816,34 @@ void ec_readeeprom1(uint16 slave, uint16 eeproma);
 uint32 ec_readeeprom2(uint16 slave, int timeout);
 int ec_send_processdata_group(uint8 group);
 int ec_receive_processdata_group(uint8 group, int timeout);
+int ec_receive_processdata_deadline(uint8 group, int64 deadline, ec_rxresultt *result);
+int ec_send_processdata_groups(const uint8 *groups, int ngroups);
+int ec_receive_processdata_groups(const uint8 *groups, int ngroups, int *groupwkc, int timeout);
+int ec_poll_processdata_group(uint8 group);
+int ec_poll_processdata_groups(const uint8 *groups, int ngroups);
+int ec_definecompletehook(uint8 group, void *hook, void *arg);
+int ec_zerocopy_attach(uint8 group);
+void ec_zerocopy_detach(uint8 group);
+int ec_pipeline_init(ec_pipelinet *pipe, uint8 group, int depth);
+int ec_frameplan_build(uint8 group);
+int ec_frameplan_wirebytes(uint8 group, int *nframes);
+int ec_diag_enable(uint8 group, boolean enable);
+uint16 ec_diag_check(uint8 group);
+int ec_fresh_enable(uint8 group, boolean enable);
+int32 ec_fresh_age(uint8 group, uint16 slave);
+int ec_safe_attach(uint8 group, uint8 *safe, uint32 size, uint16 threshold);
+void ec_safe_detach(uint8 group);
+void ec_safe_release(uint8 group);
+int ec_statusmap_cyclic(uint8 group, boolean enable);
+int ec_statusmap_read(uint8 group, int timeout);
+uint16 ec_statusmap_check(uint8 group);
+int ec_acyclic_attach(uint8 group, ec_acyclicqt *queue);
+void ec_acyclic_detach(void);
+int ec_acyclic_post(ec_acyclict *req);
+int ec_acyclic_wait(ec_acyclict *req, int timeout);
+const ec_pdoentryt *ec_pdo_entry(uint16 slave, uint16 n);
+int ec_pdo_find(uint16 slave, uint16 index, uint8 subindex, ec_pdovart *var);
+int ec_pdo_findname(uint16 slave, const char *name, ec_pdovart *var);
 int ec_send_processdata(void);
 int ec_receive_processdata(int timeout);
 #endif
@@ -509,10 +852,16 @@ ec_adaptert * ec_find_adapters(void);
 void ec_free_adapters(ec_adaptert * adapter);
 uint8 ec_nextmbxcnt(uint8 cnt);
 void ec_clearmbx(ec_mbxbuft *Mbx);
+void ec_hist_init(ec_histt *hist, int32 binwidth);
+void ec_hist_add(ec_histt *hist, int64 value);
+int64 ec_hist_percentile(const ec_histt *hist, uint32 ppm);
+void ec_hist_snapshot(const ec_histt *hist, ec_histsnapt *snap);
 void ecx_pusherror(ecx_contextt *context, const ec_errort *Ec);
 boolean ecx_poperror(ecx_contextt *context, ec_errort *Ec);
 boolean ecx_iserror(ecx_contextt *context);
 void ecx_packeterror(ecx_contextt *context, uint16 Slave, uint16 Index, uint8 SubIdx, uint16 ErrorCode);
+ecx_contextt *ecx_context_create(const ecx_contextparamt *params);
+void ecx_context_destroy(ecx_contextt *context);
 int ecx_init(ecx_contextt *context, char * ifname);
 int ecx_init_redundant(ecx_contextt *context, ecx_redportt *redport, char *ifname, char *if2name);
 void ecx_close(ecx_contextt *context);
@@ -542,6 +891,46 @@ void ecx_readeeprom1(ecx_contextt *context, uint16 slave, uint16 eeproma);
 uint32 ecx_readeeprom2(ecx_contextt *context, uint16 slave, int timeout);
 int ecx_send_processdata_group(ecx_contextt *context, uint8 group);
 int ecx_receive_processdata_group(ecx_contextt *context, uint8 group, int timeout);
+int ecx_receive_processdata_deadline(ecx_contextt *context, uint8 group, int64 deadline,
+                                     ec_rxresultt *result);
+int ecx_send_processdata_groups(ecx_contextt *context, const uint8 *groups, int ngroups);
+int ecx_receive_processdata_groups(ecx_contextt *context, const uint8 *groups, int ngroups,
+                                   int *groupwkc, int timeout);
+int ecx_poll_processdata_group(ecx_contextt *context, uint8 group);
+int ecx_poll_processdata_groups(ecx_contextt *context, const uint8 *groups, int ngroups);
+int ecx_definecompletehook(ecx_contextt *context, uint8 group, void *hook, void *arg);
+int ecx_zerocopy_attach(ecx_contextt *context, uint8 group);
+void ecx_zerocopy_detach(ecx_contextt *context, uint8 group);
+int ecx_pipeline_init(ec_pipelinet *pipe, ecx_contextt *context, uint8 group, int depth);
+uint32 ecx_pipeline_send(ec_pipelinet *pipe);
+int ecx_pipeline_receive(ec_pipelinet *pipe, uint32 *cycle, int timeout);
+uint32 ecx_pipeline_flush(ec_pipelinet *pipe, int timeout);
+int ecx_frameplan_build(ecx_contextt *context, uint8 group);
+int ecx_frameplan_wirebytes(ecx_contextt *context, uint8 group, int *nframes);
+int ecx_groupdatagramcount(ecx_contextt *context, uint8 group);
+int ecx_diag_enable(ecx_contextt *context, uint8 group, boolean enable);
+uint16 ecx_diag_check(ecx_contextt *context, uint8 group);
+int ecx_fresh_enable(ecx_contextt *context, uint8 group, boolean enable);
+int32 ecx_fresh_age(ecx_contextt *context, uint8 group, uint16 slave);
+int ecx_safe_attach(ecx_contextt *context, uint8 group, uint8 *safe, uint32 size,
+                    uint16 threshold);
+void ecx_safe_detach(ecx_contextt *context, uint8 group);
+void ecx_safe_release(ecx_contextt *context, uint8 group);
+int ecx_statusmap_cyclic(ecx_contextt *context, uint8 group, boolean enable);
+int ecx_statusmap_read(ecx_contextt *context, uint8 group, int timeout);
+uint16 ecx_statusmap_check(ecx_contextt *context, uint8 group);
+int ecx_acyclic_attach(ecx_contextt *context, uint8 group, ec_acyclicqt *queue);
+void ecx_acyclic_detach(ecx_contextt *context);
+int ecx_acyclic_post(ecx_contextt *context, ec_acyclict *req);
+int ecx_acyclic_wait(ecx_contextt *context, ec_acyclict *req, int timeout);
+void ecx_pdo_begin(ecx_contextt *context, uint16 slave);
+void ecx_pdo_add(ecx_contextt *context, uint16 slave, uint8 sm, uint16 index, uint8 subindex,
+                 uint16 bitlen, uint32 bitoffset, uint16 datatype, uint8 name);
+void ecx_pdo_end(ecx_contextt *context, uint16 slave);
+const ec_pdoentryt *ecx_pdo_entry(ecx_contextt *context, uint16 slave, uint16 n);
+int ecx_pdo_find(ecx_contextt *context, uint16 slave, uint16 index, uint8 subindex,
+                 ec_pdovart *var);
+int ecx_pdo_findname(ecx_contextt *context, uint16 slave, const char *name, ec_pdovart *var);
 int ecx_send_processdata(ecx_contextt *context);
 int ecx_receive_processdata(ecx_contextt *context, int timeout);
 
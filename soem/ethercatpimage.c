@@ -0,0 +1,256 @@
+/*
+ * Simple Open EtherCAT Master Library 
+ *
+ * File    : ethercatpimage.c
+ * Version : 1.3.1
+ * Date    : 24-02-2013
+ * Copyright (C) 2005-2013 Speciaal Machinefabriek Ketels v.o.f.
+ * Copyright (C) 2005-2013 Arthur Ketels
+ * Copyright (C) 2008-2009 TU/e Technische Universiteit Eindhoven 
+ *
+ * SOEM is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License version 2 as published by the Free
+ * Software Foundation.
+ *
+ * SOEM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * for more details.
+ *
+ * As a special exception, if other files instantiate templates or use macros
+ * or inline functions from this file, or you compile this file and link it
+ * with other works to produce a work based on this file, this file does not
+ * by itself cause the resulting work to be covered by the GNU General Public
+ * License. However the source code for this file must still be made available
+ * in accordance with section (3) of the GNU General Public License.
+ *
+ * This exception does not invalidate any other reasons why a work based on
+ * this file might be covered by the GNU General Public License.
+ *
+ * The EtherCAT Technology, the trade name and logo “EtherCAT” are the intellectual
+ * property of, and protected by Beckhoff Automation GmbH. You can use SOEM for
+ * the sole purpose of creating, using and/or selling or otherwise distributing
+ * an EtherCAT network master provided that an EtherCAT Master License is obtained
+ * from Beckhoff Automation GmbH.
+ *
+ * In case you did not receive a copy of the EtherCAT Master License along with
+ * SOEM write to Beckhoff Automation GmbH, Eiserstraße 5, D-33415 Verl, Germany
+ * (www.beckhoff.com).
+ */
+
+/** \file
+ * \brief
+ * Buffered process image.
+ *
+ * Optional decoupling of the IOmap from application threads. The inputs
+ * are published after every receive in a ring of 2 or 3 buffers with a
+ * sequence number (seqlock) per buffer and a generation counter. Readers
+ * copy a snapshot and retry if the buffer was overwritten meanwhile, with
+ * 3 buffers that needs a reader delayed by more than a full cycle.
+ * The outputs use a triple buffer, the application fills its own buffer
+ * and commits it with an atomic exchange, the send picks up the latest
+ * committed buffer with an atomic exchange.
+ */
+#include <string.h>
+#include "oshw.h"
+#include "osal.h"
+#include "ethercattype.h"
+#include "ethercatbase.h"
+#include "ethercatmain.h"
+#include "ethercatpimage.h"
+
+/** Attach buffered process image to a group. Call after the group is
+ * mapped, the current IOmap content is the initial image. From then on
+ * send and receive of the group go through the image.
+ * @param[in]  context    = context struct
+ * @param[in]  group      = group number
+ * @param[out] pimage     = process image
+ * @param[in]  nbuf       = number of input buffers, 2 or 3
+ * @param[in]  buf        = buffer memory
+ * @param[in]  bufsize    = size of buffer memory, see EC_PIMAGE_BUFSIZE
+ * @return 1 if attached, 0 on invalid arguments or a zero copy group
+ */
+int ecx_pimage_attach(ecx_contextt *context, uint8 group, ec_pimaget *pimage, int nbuf,
+                      void *buf, size_t bufsize)
+{
+   ec_groupt *grp;
+   uint8 *p;
+   int i;
+
+   if ((group >= context->maxgroup) || (nbuf < 2) || (nbuf > EC_PIMAGE_MAXBUF))
+   {
+      return 0;
+   }
+   grp = &context->grouplist[group];
+   /* zero copy groups do not use the IOmap */
+   if (grp->zerocopy || (buf == NULL) ||
+       (bufsize < EC_PIMAGE_BUFSIZE(grp->Obytes, grp->Ibytes, nbuf)))
+   {
+      return 0;
+   }
+   memset(pimage, 0, sizeof(ec_pimaget));
+   pimage->Obytes = grp->Obytes;
+   pimage->Ibytes = grp->Ibytes;
+   pimage->nbuf = nbuf;
+   p = (uint8 *)buf;
+   for (i = 0; i < EC_PIMAGE_OUTBUF; i++)
+   {
+      pimage->obuf[i] = p;
+      if (grp->Obytes)
+      {
+         memcpy(p, grp->outputs, grp->Obytes);
+      }
+      p += grp->Obytes;
+   }
+   for (i = 0; i < nbuf; i++)
+   {
+      pimage->ibuf[i] = p;
+      if (grp->Ibytes)
+      {
+         memcpy(p, grp->inputs, grp->Ibytes);
+      }
+      p += grp->Ibytes;
+   }
+   pimage->oapp = 0;
+   pimage->opending = 1;
+   pimage->ocyclic = 2;
+   grp->pimage = pimage;
+
+   return 1;
+}
+
+/** Detach buffered process image from a group. Must not run concurrently
+ * with send or receive of the group.
+ * @param[in]  context    = context struct
+ * @param[in]  group      = group number
+ */
+void ecx_pimage_detach(ecx_contextt *context, uint8 group)
+{
+   if (group < context->maxgroup)
+   {
+      context->grouplist[group].pimage = NULL;
+   }
+}
+
+/** Read a consistent snapshot of the inputs of the last complete cycle.
+ * Can be called from several threads at the same time.
+ * @param[in]  pimage     = process image
+ * @param[out] dst        = destination
+ * @param[in]  offset     = offset in the input image of the group
+ * @param[in]  length     = number of bytes to read
+ * @param[out] wkc        = workcounter of the cycle, can be NULL
+ * @return generation of the snapshot, 0 if no cycle published yet or out of range.
+ * The generation is taken from the buffer, so it always belongs to the data
+ * even if newer cycles were published during the read.
+ */
+uint32 ecx_pimage_read(ec_pimaget *pimage, void *dst, uint32 offset, uint32 length, int *wkc)
+{
+   uint32 gen, seq, b;
+   int cwkc;
+
+   if ((offset + length) > pimage->Ibytes)
+   {
+      return 0;
+   }
+   do
+   {
+      gen = osal_atomic_load(&pimage->generation);
+      b = gen % pimage->nbuf;
+      seq = osal_atomic_load(&pimage->iseq[b]);
+      memcpy(dst, pimage->ibuf[b] + offset, length);
+      cwkc = pimage->iwkc[b];
+      gen = pimage->igen[b];
+      osal_atomic_fence();
+   } while ((seq & 1) || (seq != pimage->iseq[b]));
+   if (wkc)
+   {
+      *wkc = cwkc;
+   }
+
+   return gen;
+}
+
+/** Output buffer of the application. Only one application thread may
+ * write outputs. The buffer holds the last committed outputs.
+ * @param[in]  pimage     = process image
+ * @return pointer to the output image of the group
+ */
+uint8 *ecx_pimage_outputs(ec_pimaget *pimage)
+{
+   return pimage->obuf[pimage->oapp];
+}
+
+/** Commit the application output buffer, the next send transmits it.
+ * @param[in,out] pimage  = process image
+ */
+void ecx_pimage_commit(ec_pimaget *pimage)
+{
+   uint32 committed;
+
+   committed = pimage->oapp;
+   pimage->oapp = osal_atomic_exchange(&pimage->opending, committed | EC_PIMAGE_FRESH) &
+                  ~EC_PIMAGE_FRESH;
+   /* continue from the committed outputs */
+   if (pimage->Obytes)
+   {
+      memcpy(pimage->obuf[pimage->oapp], pimage->obuf[committed], pimage->Obytes);
+   }
+}
+
+/** Publish inputs of a complete cycle, cyclic side.
+ * @param[in,out] pimage  = process image
+ * @param[in]  inputs     = inputs of the group in the IOmap
+ * @param[in]  wkc        = workcounter of the cycle
+ */
+void ecx_pimage_publish(ec_pimaget *pimage, const uint8 *inputs, int wkc)
+{
+   uint32 gen, b;
+
+   gen = pimage->generation + 1;
+   /* generation 0 means nothing published, skip it at wrap around */
+   if (gen == 0)
+   {
+      gen = pimage->nbuf;
+   }
+   b = gen % pimage->nbuf;
+   osal_atomic_store(&pimage->iseq[b], pimage->iseq[b] + 1);
+   osal_atomic_fence();
+   if (pimage->Ibytes)
+   {
+      memcpy(pimage->ibuf[b], inputs, pimage->Ibytes);
+   }
+   pimage->iwkc[b] = wkc;
+   pimage->igen[b] = gen;
+   osal_atomic_store(&pimage->iseq[b], pimage->iseq[b] + 1);
+   osal_atomic_store(&pimage->generation, gen);
+}
+
+/** Pick up the latest committed outputs, cyclic side.
+ * @param[in,out] pimage  = process image
+ * @param[out] outputs    = outputs of the group in the IOmap
+ */
+void ecx_pimage_fetch(ec_pimaget *pimage, uint8 *outputs)
+{
+   if (osal_atomic_load(&pimage->opending) & EC_PIMAGE_FRESH)
+   {
+      pimage->ocyclic = osal_atomic_exchange(&pimage->opending, pimage->ocyclic) &
+                        ~EC_PIMAGE_FRESH;
+      pimage->ogeneration++;
+   }
+   if (pimage->Obytes)
+   {
+      memcpy(outputs, pimage->obuf[pimage->ocyclic], pimage->Obytes);
+   }
+}
+
+#ifdef EC_VER1
+int ec_pimage_attach(uint8 group, ec_pimaget *pimage, int nbuf, void *buf, size_t bufsize)
+{
+   return ecx_pimage_attach(&ecx_context, group, pimage, nbuf, buf, bufsize);
+}
+
+void ec_pimage_detach(uint8 group)
+{
+   ecx_pimage_detach(&ecx_context, group);
+}
+#endif
@@ -0,0 +1,116 @@
+/*
+ * Simple Open EtherCAT Master Library 
+ *
+ * File    : ethercatpimage.h
+ * Version : 1.3.1
+ * Date    : 24-02-2013
+ * Copyright (C) 2005-2013 Speciaal Machinefabriek Ketels v.o.f.
+ * Copyright (C) 2005-2013 Arthur Ketels
+ * Copyright (C) 2008-2009 TU/e Technische Universiteit Eindhoven 
+ *
+ * SOEM is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License version 2 as published by the Free
+ * Software Foundation.
+ *
+ * SOEM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * for more details.
+ *
+ * As a special exception, if other files instantiate templates or use macros
+ * or inline functions from this file, or you compile this file and link it
+ * with other works to produce a work based on this file, this file does not
+ * by itself cause the resulting work to be covered by the GNU General Public
+ * License. However the source code for this file must still be made available
+ * in accordance with section (3) of the GNU General Public License.
+ *
+ * This exception does not invalidate any other reasons why a work based on
+ * this file might be covered by the GNU General Public License.
+ *
+ * The EtherCAT Technology, the trade name and logo “EtherCAT” are the intellectual
+ * property of, and protected by Beckhoff Automation GmbH. You can use SOEM for
+ * the sole purpose of creating, using and/or selling or otherwise distributing
+ * an EtherCAT network master provided that an EtherCAT Master License is obtained
+ * from Beckhoff Automation GmbH.
+ *
+ * In case you did not receive a copy of the EtherCAT Master License along with
+ * SOEM write to Beckhoff Automation GmbH, Eiserstraße 5, D-33415 Verl, Germany
+ * (www.beckhoff.com).
+ */
+
+/** \file 
+ * \brief
+ * Headerfile for ethercatpimage.c 
+ */
+
+#ifndef _EC_ECATPIMAGE_H
+#define _EC_ECATPIMAGE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** max. number of input buffers */
+#define EC_PIMAGE_MAXBUF   3
+/** number of output buffers, application, pending and cyclic */
+#define EC_PIMAGE_OUTBUF   3
+/** flag in pending output index, set when the application committed new outputs */
+#define EC_PIMAGE_FRESH    0x80000000
+/** buffer size needed for a process image of a group */
+#define EC_PIMAGE_BUFSIZE(Obytes, Ibytes, nbuf) \
+   (((Obytes) * EC_PIMAGE_OUTBUF) + ((Ibytes) * (nbuf)))
+
+/** Buffered process image of a group. The cyclic thread publishes the
+ * inputs of every complete cycle, application threads read a consistent
+ * snapshot. Outputs are staged by one application thread and picked up as
+ * a whole by the next send. Neither side ever blocks the other. */
+typedef struct ec_pimage
+{
+   /** output bytes of the group */
+   uint32          Obytes;
+   /** input bytes of the group */
+   uint32          Ibytes;
+   /** number of input buffers, 2 or 3 */
+   uint32          nbuf;
+   /** input buffers */
+   uint8           *ibuf[EC_PIMAGE_MAXBUF];
+   /** workcounter of the cycle in each input buffer */
+   int             iwkc[EC_PIMAGE_MAXBUF];
+   /** generation of the cycle in each input buffer */
+   uint32          igen[EC_PIMAGE_MAXBUF];
+   /** sequence number of each input buffer, odd while being written */
+   volatile uint32 iseq[EC_PIMAGE_MAXBUF];
+   /** number of published input cycles, selects the latest input buffer */
+   volatile uint32 generation;
+   /** output buffers */
+   uint8           *obuf[EC_PIMAGE_OUTBUF];
+   /** output buffer owned by the application */
+   uint32          oapp;
+   /** output buffer owned by the cyclic thread */
+   uint32          ocyclic;
+   /** output buffer in between, with EC_PIMAGE_FRESH if not picked up yet */
+   volatile uint32 opending;
+   /** number of output images picked up by the cyclic thread */
+   uint32          ogeneration;
+} ec_pimaget;
+
+#ifdef EC_VER1
+int ec_pimage_attach(uint8 group, ec_pimaget *pimage, int nbuf, void *buf, size_t bufsize);
+void ec_pimage_detach(uint8 group);
+#endif
+
+int ecx_pimage_attach(ecx_contextt *context, uint8 group, ec_pimaget *pimage, int nbuf,
+                      void *buf, size_t bufsize);
+void ecx_pimage_detach(ecx_contextt *context, uint8 group);
+uint32 ecx_pimage_read(ec_pimaget *pimage, void *dst, uint32 offset, uint32 length, int *wkc);
+uint8 *ecx_pimage_outputs(ec_pimaget *pimage);
+void ecx_pimage_commit(ec_pimaget *pimage);
+void ecx_pimage_publish(ec_pimaget *pimage, const uint8 *inputs, int wkc);
+void ecx_pimage_fetch(ec_pimaget *pimage, uint8 *outputs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _EC_ECATPIMAGE_H */
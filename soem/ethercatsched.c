@@ -0,0 +1,248 @@
+/*
+ * Simple Open EtherCAT Master Library 
+ *
+ * File    : ethercatsched.c 
+ * Version : 1.3.1
+ * Date    : 24-02-2013
+ * Copyright (C) 2005-2013 Speciaal Machinefabriek Ketels v.o.f.
+ * Copyright (C) 2005-2013 Arthur Ketels
+ * Copyright (C) 2008-2009 TU/e Technische Universiteit Eindhoven 
+ *
+ * SOEM is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License version 2 as published by the Free
+ * Software Foundation.
+ *
+ * SOEM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * for more details.
+ *
+ * As a special exception, if other files instantiate templates or use macros
+ * or inline functions from this file, or you compile this file and link it
+ * with other works to produce a work based on this file, this file does not
+ * by itself cause the resulting work to be covered by the GNU General Public
+ * License. However the source code for this file must still be made available
+ * in accordance with section (3) of the GNU General Public License.
+ *
+ * This exception does not invalidate any other reasons why a work based on
+ * this file might be covered by the GNU General Public License.
+ *
+ * The EtherCAT Technology, the trade name and logo “EtherCAT” are the intellectual
+ * property of, and protected by Beckhoff Automation GmbH. You can use SOEM for
+ * the sole purpose of creating, using and/or selling or otherwise distributing
+ * an EtherCAT network master provided that an EtherCAT Master License is obtained
+ * from Beckhoff Automation GmbH.
+ *
+ * In case you did not receive a copy of the EtherCAT Master License along with
+ * SOEM write to Beckhoff Automation GmbH, Eiserstraße 5, D-33415 Verl, Germany
+ * (www.beckhoff.com).
+ */
+
+/** \file
+ * \brief
+ * Multi-rate process data scheduler.
+ *
+ * Exchanges several groups at different rates on one segment. Every group
+ * has a period that is an integer multiple of the base tick. On each base
+ * tick the datagrams of all due groups are packed together in shared frames,
+ * sent and received. Workcounter, lateness and overruns are kept per group.
+ */
+#include <string.h>
+#include "oshw.h"
+#include "osal.h"
+#include "ethercattype.h"
+#include "ethercatbase.h"
+#include "ethercatmain.h"
+#include "ethercatsched.h"
+
+/** Initialise multi-rate scheduler. The group table is owned by the
+ * application so the number of groups is not limited by EC_MAXGROUP,
+ * use a context with a larger maxgroup (ecx_context_create) for more groups.
+ * @param[out] sched      = scheduler state
+ * @param[in]  context    = context struct
+ * @param[in]  basetick   = base tick in ns
+ * @param[in]  groups     = group table
+ * @param[in]  maxgroups  = number of entries in group table
+ */
+void ecx_sched_init(ec_schedt *sched, ecx_contextt *context, int64 basetick,
+                    ec_schedgroupt *groups, int maxgroups)
+{
+   memset(sched, 0, sizeof(ec_schedt));
+   memset(groups, 0, sizeof(ec_schedgroupt) * maxgroups);
+   sched->context = context;
+   sched->basetick = basetick;
+   sched->groups = groups;
+   sched->maxgroups = maxgroups;
+   sched->timeout = EC_TIMEOUTRET;
+}
+
+/** Add group to scheduler.
+ * @param[in,out] sched   = scheduler state
+ * @param[in]  group      = group number in the context
+ * @param[in]  period     = period in base ticks
+ * @param[in]  phase      = phase in base ticks, spreads groups with the same period
+ * @return index in group table, -1 if the table is full or the group is invalid
+ */
+int ecx_sched_addgroup(ec_schedt *sched, uint8 group, uint32 period, uint32 phase)
+{
+   ec_schedgroupt *sg;
+
+   if ((sched->ngroups >= sched->maxgroups) || (group >= sched->context->maxgroup) ||
+       (period < 1) || (sched->ngroups >= EC_MAXGROUPLIST))
+   {
+      return -1;
+   }
+   sg = &sched->groups[sched->ngroups];
+   memset(sg, 0, sizeof(ec_schedgroupt));
+   sg->group = group;
+   sg->period = period;
+   sg->phase = phase % period;
+   sg->expectedwkc = (sched->context->grouplist[group].outputsWKC * 2) +
+                     sched->context->grouplist[group].inputsWKC;
+
+   return sched->ngroups++;
+}
+
+/** Execute the current base tick and advance to the next one. All due groups
+ * are sent packed together, then received. Does not wait for the tick release,
+ * that is done by ecx_sched_run(). With start 0 the lateness is not measured.
+ * @param[in,out] sched   = scheduler state
+ * @return number of groups exchanged
+ */
+int ecx_sched_tick(ec_schedt *sched)
+{
+   uint8 due[EC_MAXGROUPLIST];
+   int duewkc[EC_MAXGROUPLIST];
+   int dueidx[EC_MAXGROUPLIST];
+   int i, ndue;
+   int64 release, now;
+   ec_schedgroupt *sg;
+
+   ndue = 0;
+   release = sched->start + ((int64)sched->tick * sched->basetick);
+   for (i = 0; i < sched->ngroups; i++)
+   {
+      sg = &sched->groups[i];
+      sg->due = ((sched->tick % sg->period) == sg->phase);
+      if (sg->due)
+      {
+         due[ndue] = sg->group;
+         dueidx[ndue] = i;
+         ndue++;
+      }
+   }
+   if (ndue)
+   {
+      now = sched->start ? osal_current_time_ns() : 0;
+      ecx_send_processdata_groups(sched->context, due, ndue);
+      ecx_receive_processdata_groups(sched->context, due, ndue, duewkc, sched->timeout);
+      for (i = 0; i < ndue; i++)
+      {
+         sg = &sched->groups[dueidx[i]];
+         sg->wkc = duewkc[i];
+         sg->cycles++;
+         if (sg->expectedwkc && (sg->wkc != sg->expectedwkc))
+         {
+            sg->wkcerrors++;
+         }
+         if (sched->start)
+         {
+            sg->lateness = now - release;
+            if (sg->lateness > sg->maxlate)
+            {
+               sg->maxlate = sg->lateness;
+            }
+         }
+      }
+      if (sched->start)
+      {
+         /* exchange has to be complete within the period of the group */
+         now = osal_current_time_ns();
+         for (i = 0; i < ndue; i++)
+         {
+            sg = &sched->groups[dueidx[i]];
+            if (now > (release + ((int64)sg->period * sched->basetick)))
+            {
+               sg->overruns++;
+            }
+         }
+      }
+   }
+   sched->tick++;
+
+   return ndue;
+}
+
+/* count overruns of the groups that were due in a skipped base tick */
+static void ecx_sched_skip(ec_schedt *sched)
+{
+   int i;
+   ec_schedgroupt *sg;
+
+   for (i = 0; i < sched->ngroups; i++)
+   {
+      sg = &sched->groups[i];
+      if ((sched->tick % sg->period) == sg->phase)
+      {
+         sg->overruns++;
+      }
+   }
+   sched->tick++;
+   sched->overruns++;
+}
+
+/** Run scheduler until stopped. Intended as thread function, the
+ * caller is responsible for priority and affinity of the thread.
+ * @param[in,out] sched   = scheduler state, with groups added
+ */
+void ecx_sched_run(ec_schedt *sched)
+{
+   int64 now;
+
+   /* first tick on a whole base tick boundary */
+   now = osal_current_time_ns();
+   sched->start = now - (now % sched->basetick) + sched->basetick;
+   sched->tick = 0;
+   /* stopped before the thread came up */
+   if (sched->stop)
+   {
+      return;
+   }
+   while (1)
+   {
+      osal_sleep_until_ns(sched->start + ((int64)sched->tick * sched->basetick));
+      ecx_sched_tick(sched);
+      if (sched->hook && !sched->hook(sched, sched->hookarg))
+      {
+         sched->stop = 1;
+      }
+      if (sched->stop)
+      {
+         break;
+      }
+      /* skip ticks that are already in the past, keep the phase */
+      now = osal_current_time_ns();
+      while ((sched->start + ((int64)(sched->tick + 1) * sched->basetick)) <= now)
+      {
+         ecx_sched_skip(sched);
+      }
+   }
+}
+
+/** Request scheduler to stop. The scheduler ends after the
+ * receive of the running tick, no process data is left in flight.
+ * A request before the scheduler runs is kept, restart with
+ * ecx_sched_init().
+ * @param[in,out] sched   = scheduler state
+ */
+void ecx_sched_stop(ec_schedt *sched)
+{
+   sched->stop = 1;
+}
+
+#ifdef EC_VER1
+void ec_sched_init(ec_schedt *sched, int64 basetick, ec_schedgroupt *groups, int maxgroups)
+{
+   ecx_sched_init(sched, &ecx_context, basetick, groups, maxgroups);
+}
+#endif
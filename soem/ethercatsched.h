@@ -0,0 +1,131 @@
+/*
+ * Simple Open EtherCAT Master Library 
+ *
+ * File    : ethercatsched.h 
+ * Version : 1.3.1
+ * Date    : 24-02-2013
+ * Copyright (C) 2005-2013 Speciaal Machinefabriek Ketels v.o.f.
+ * Copyright (C) 2005-2013 Arthur Ketels
+ * Copyright (C) 2008-2009 TU/e Technische Universiteit Eindhoven 
+ *
+ * SOEM is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License version 2 as published by the Free
+ * Software Foundation.
+ *
+ * SOEM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * for more details.
+ *
+ * As a special exception, if other files instantiate templates or use macros
+ * or inline functions from this file, or you compile this file and link it
+ * with other works to produce a work based on this file, this file does not
+ * by itself cause the resulting work to be covered by the GNU General Public
+ * License. However the source code for this file must still be made available
+ * in accordance with section (3) of the GNU General Public License.
+ *
+ * This exception does not invalidate any other reasons why a work based on
+ * this file might be covered by the GNU General Public License.
+ *
+ * The EtherCAT Technology, the trade name and logo “EtherCAT” are the intellectual
+ * property of, and protected by Beckhoff Automation GmbH. You can use SOEM for
+ * the sole purpose of creating, using and/or selling or otherwise distributing
+ * an EtherCAT network master provided that an EtherCAT Master License is obtained
+ * from Beckhoff Automation GmbH.
+ *
+ * In case you did not receive a copy of the EtherCAT Master License along with
+ * SOEM write to Beckhoff Automation GmbH, Eiserstraße 5, D-33415 Verl, Germany
+ * (www.beckhoff.com).
+ */
+
+/** \file 
+ * \brief
+ * Headerfile for ethercatsched.c 
+ */
+
+#ifndef _EC_ECATSCHED_H
+#define _EC_ECATSCHED_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct ec_sched ec_schedt;
+
+/** Application hook, called every base tick after the receive of the due
+ * groups and before the next send. Return 0 to stop the scheduler. */
+typedef int (*ec_schedhookt)(ec_schedt *sched, void *arg);
+
+/** Process data group in the multi-rate scheduler */
+typedef struct
+{
+   /** group number in the context */
+   uint8          group;
+   /** period in base ticks, >= 1 */
+   uint32         period;
+   /** phase in base ticks, the group is due when tick % period == phase */
+   uint32         phase;
+   /** expected workcounter, 0 = no check */
+   int            expectedwkc;
+   /** set when the group was exchanged in the last base tick */
+   boolean        due;
+   /** workcounter of last exchange */
+   int            wkc;
+   /** number of exchanges */
+   uint32         cycles;
+   /** number of exchanges with a workcounter other than expected */
+   uint32         wkcerrors;
+   /** number of exchanges that completed after the group period or were skipped */
+   uint32         overruns;
+   /** lateness of the last send relative to the scheduled release in ns */
+   int64          lateness;
+   /** largest lateness in ns */
+   int64          maxlate;
+} ec_schedgroupt;
+
+/** Multi-rate process data scheduler state */
+struct ec_sched
+{
+   /** context the process data is exchanged on */
+   ecx_contextt   *context;
+   /** base tick in ns, all group periods are a multiple of it */
+   int64          basetick;
+   /** group table, supplied by the application */
+   ec_schedgroupt *groups;
+   /** number of used entries in the group table */
+   int            ngroups;
+   /** number of entries in the group table */
+   int            maxgroups;
+   /** timeout in us for receive of the process data */
+   int            timeout;
+   /** application hook, can be NULL */
+   ec_schedhookt  hook;
+   /** argument passed to the application hook */
+   void           *hookarg;
+   /** set to stop the scheduler at the next base tick */
+   volatile int   stop;
+   /** absolute time of base tick 0 in ns */
+   int64          start;
+   /** current base tick */
+   uint64         tick;
+   /** number of base ticks skipped because the previous tick ran too long */
+   uint32         overruns;
+};
+
+#ifdef EC_VER1
+void ec_sched_init(ec_schedt *sched, int64 basetick, ec_schedgroupt *groups, int maxgroups);
+#endif
+
+void ecx_sched_init(ec_schedt *sched, ecx_contextt *context, int64 basetick,
+                    ec_schedgroupt *groups, int maxgroups);
+int ecx_sched_addgroup(ec_schedt *sched, uint8 group, uint32 period, uint32 phase);
+int ecx_sched_tick(ec_schedt *sched);
+void ecx_sched_run(ec_schedt *sched);
+void ecx_sched_stop(ec_schedt *sched);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _EC_ECATSCHED_H */
@@ -0,0 +1,254 @@
+/*
+ * Simple Open EtherCAT Master Library 
+ *
+ * File    : ethercattiming.c
+ * Version : 1.3.1
+ * Date    : 24-02-2013
+ * Copyright (C) 2005-2013 Speciaal Machinefabriek Ketels v.o.f.
+ * Copyright (C) 2005-2013 Arthur Ketels
+ * Copyright (C) 2008-2009 TU/e Technische Universiteit Eindhoven 
+ *
+ * SOEM is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License version 2 as published by the Free
+ * Software Foundation.
+ *
+ * SOEM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * for more details.
+ *
+ * As a special exception, if other files instantiate templates or use macros
+ * or inline functions from this file, or you compile this file and link it
+ * with other works to produce a work based on this file, this file does not
+ * by itself cause the resulting work to be covered by the GNU General Public
+ * License. However the source code for this file must still be made available
+ * in accordance with section (3) of the GNU General Public License.
+ *
+ * This exception does not invalidate any other reasons why a work based on
+ * this file might be covered by the GNU General Public License.
+ *
+ * The EtherCAT Technology, the trade name and logo “EtherCAT” are the intellectual
+ * property of, and protected by Beckhoff Automation GmbH. You can use SOEM for
+ * the sole purpose of creating, using and/or selling or otherwise distributing
+ * an EtherCAT network master provided that an EtherCAT Master License is obtained
+ * from Beckhoff Automation GmbH.
+ *
+ * In case you did not receive a copy of the EtherCAT Master License along with
+ * SOEM write to Beckhoff Automation GmbH, Eiserstraße 5, D-33415 Verl, Germany
+ * (www.beckhoff.com).
+ */
+
+/** \file
+ * \brief
+ * Process data timing.
+ *
+ * Optional log scale histograms of the round trip time, the period and the
+ * duration of the receive call of a group. The cyclic thread takes one
+ * clock reading per send, per receive call and per group completion and
+ * adds the samples without locking. A snapshot asks the cyclic thread to
+ * switch to the second set of histograms and summarizes the set it left,
+ * so neither side ever blocks the other.
+ */
+#include <string.h>
+#include "oshw.h"
+#include "osal.h"
+#include "ethercattype.h"
+#include "ethercatbase.h"
+#include "ethercatmain.h"
+#include "ethercattiming.h"
+
+/** Clear one set of histograms.
+ * @param[out] timing     = timing
+ * @param[in]  set        = set number, 0 or 1
+ */
+static void ecx_timing_clear(ec_timingt *timing, uint32 set)
+{
+   ec_hist_init(&timing->rtt[set], EC_HISTLOG);
+   ec_hist_init(&timing->period[set], EC_HISTLOG);
+   ec_hist_init(&timing->receive[set], EC_HISTLOG);
+}
+
+/** Attach process data timing to a group. From then on every send and
+ * receive of the group is timed. All sends and receives of the group
+ * must come from one thread.
+ * @param[in]  context    = context struct
+ * @param[in]  group      = group number
+ * @param[out] timing     = timing
+ * @return 1 if attached, 0 on invalid arguments
+ */
+int ecx_timing_attach(ecx_contextt *context, uint8 group, ec_timingt *timing)
+{
+   if ((group >= context->maxgroup) || !timing)
+   {
+      return 0;
+   }
+   memset(timing, 0, sizeof(ec_timingt));
+   ecx_timing_clear(timing, 0);
+   ecx_timing_clear(timing, 1);
+   context->grouplist[group].timing = timing;
+
+   return 1;
+}
+
+/** Detach process data timing from a group.
+ * @param[in]  context    = context struct
+ * @param[in]  group      = group number
+ */
+void ecx_timing_detach(ecx_contextt *context, uint8 group)
+{
+   if (group < context->maxgroup)
+   {
+      context->grouplist[group].timing = NULL;
+   }
+}
+
+/** Summarize the timing of a group since the previous snapshot and restart.
+ * Waits for the next send of the group to switch histogram sets.
+ * @param[in]  context    = context struct
+ * @param[in]  group      = group number
+ * @param[out] snap       = summary
+ * @param[in]  timeout    = Timeout in us to wait for the switch.
+ * @return 1 if summarized, 0 if no timing attached or the group did not send
+ * within timeout
+ */
+int ecx_timing_snapshot(ecx_contextt *context, uint8 group, ec_timingsnapt *snap, int timeout)
+{
+   ec_timingt *timing;
+   osal_timert timer;
+   uint32 set;
+
+   if ((group >= context->maxgroup) || !context->grouplist[group].timing)
+   {
+      return 0;
+   }
+   timing = context->grouplist[group].timing;
+   osal_timer_start(&timer, timeout);
+   osal_atomic_store(&timing->request, 1);
+   while (osal_atomic_load(&timing->request))
+   {
+      if (osal_timer_is_expired(&timer))
+      {
+         /* the switch stays requested, the next snapshot picks it up */
+         return 0;
+      }
+      osal_usleep(100);
+   }
+   set = osal_atomic_load(&timing->active) ^ 1;
+   ec_hist_snapshot(&timing->rtt[set], &snap->rtt);
+   ec_hist_snapshot(&timing->period[set], &snap->period);
+   ec_hist_snapshot(&timing->receive[set], &snap->receive);
+
+   return 1;
+}
+
+/** Time a send. Called by the send functions before the frames go out.
+ * Switches histogram sets on request of a snapshot and adds the period.
+ * @param[in]  context    = context struct
+ * @param[in]  groups     = list of group numbers
+ * @param[in]  ngroups    = number of groups in list
+ * @return send time in ns, 0 if none of the groups is timed
+ */
+int64 ecx_timing_send(ecx_contextt *context, const uint8 *groups, int ngroups)
+{
+   ec_timingt *timing;
+   int64 now = 0;
+   uint32 set;
+   int i;
+
+   for (i = 0; i < ngroups; i++)
+   {
+      timing = context->grouplist[groups[i]].timing;
+      if (!timing)
+      {
+         continue;
+      }
+      if (!now)
+      {
+         now = osal_current_time_ns();
+      }
+      if (osal_atomic_load(&timing->request))
+      {
+         set = timing->active ^ 1;
+         ecx_timing_clear(timing, set);
+         osal_atomic_store(&timing->active, set);
+         osal_atomic_store(&timing->request, 0);
+      }
+      if (timing->lastsend)
+      {
+         ec_hist_add(&timing->period[timing->active], now - timing->lastsend);
+      }
+      timing->lastsend = now;
+   }
+
+   return now;
+}
+
+/** Start time of a receive call.
+ * @param[in]  context    = context struct
+ * @param[in]  groups     = list of group numbers
+ * @param[in]  ngroups    = number of groups in list
+ * @return time in ns, 0 if none of the groups is timed
+ */
+int64 ecx_timing_start(ecx_contextt *context, const uint8 *groups, int ngroups)
+{
+   int i;
+
+   for (i = 0; i < ngroups; i++)
+   {
+      if (context->grouplist[groups[i]].timing)
+      {
+         return osal_current_time_ns();
+      }
+   }
+
+   return 0;
+}
+
+/** Add the duration of a receive call to the timed groups.
+ * @param[in]  context    = context struct
+ * @param[in]  groups     = list of group numbers
+ * @param[in]  ngroups    = number of groups in list
+ * @param[in]  start      = start time from ecx_timing_start()
+ */
+void ecx_timing_receive(ecx_contextt *context, const uint8 *groups, int ngroups, int64 start)
+{
+   ec_timingt *timing;
+   int64 duration;
+   int i;
+
+   duration = osal_current_time_ns() - start;
+   for (i = 0; i < ngroups; i++)
+   {
+      timing = context->grouplist[groups[i]].timing;
+      if (timing)
+      {
+         ec_hist_add(&timing->receive[timing->active], duration);
+      }
+   }
+}
+
+/** Add the round trip time of a completed group.
+ * @param[in]  timing     = timing of the group
+ * @param[in]  sendtime   = send time from ecx_timing_send()
+ */
+void ecx_timing_complete(ec_timingt *timing, int64 sendtime)
+{
+   ec_hist_add(&timing->rtt[timing->active], osal_current_time_ns() - sendtime);
+}
+
+#ifdef EC_VER1
+int ec_timing_attach(uint8 group, ec_timingt *timing)
+{
+   return ecx_timing_attach(&ecx_context, group, timing);
+}
+
+void ec_timing_detach(uint8 group)
+{
+   ecx_timing_detach(&ecx_context, group);
+}
+
+int ec_timing_snapshot(uint8 group, ec_timingsnapt *snap, int timeout)
+{
+   return ecx_timing_snapshot(&ecx_context, group, snap, timeout);
+}
+#endif
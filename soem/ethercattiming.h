@@ -0,0 +1,104 @@
+/*
+ * Simple Open EtherCAT Master Library 
+ *
+ * File    : ethercattiming.h
+ * Version : 1.3.1
+ * Date    : 24-02-2013
+ * Copyright (C) 2005-2013 Speciaal Machinefabriek Ketels v.o.f.
+ * Copyright (C) 2005-2013 Arthur Ketels
+ * Copyright (C) 2008-2009 TU/e Technische Universiteit Eindhoven 
+ *
+ * SOEM is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU General Public License version 2 as published by the Free
+ * Software Foundation.
+ *
+ * SOEM is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * for more details.
+ *
+ * As a special exception, if other files instantiate templates or use macros
+ * or inline functions from this file, or you compile this file and link it
+ * with other works to produce a work based on this file, this file does not
+ * by itself cause the resulting work to be covered by the GNU General Public
+ * License. However the source code for this file must still be made available
+ * in accordance with section (3) of the GNU General Public License.
+ *
+ * This exception does not invalidate any other reasons why a work based on
+ * this file might be covered by the GNU General Public License.
+ *
+ * The EtherCAT Technology, the trade name and logo “EtherCAT” are the intellectual
+ * property of, and protected by Beckhoff Automation GmbH. You can use SOEM for
+ * the sole purpose of creating, using and/or selling or otherwise distributing
+ * an EtherCAT network master provided that an EtherCAT Master License is obtained
+ * from Beckhoff Automation GmbH.
+ *
+ * In case you did not receive a copy of the EtherCAT Master License along with
+ * SOEM write to Beckhoff Automation GmbH, Eiserstraße 5, D-33415 Verl, Germany
+ * (www.beckhoff.com).
+ */
+
+/** \file 
+ * \brief
+ * Headerfile for ethercattiming.c 
+ */
+
+#ifndef _EC_ECATTIMING_H
+#define _EC_ECATTIMING_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** Process data timing of a group. Filled by the thread cycling the group,
+ * summarized by ecx_timing_snapshot() from any thread. All histograms are
+ * log scale in ns. There are two sets of histograms, the cyclic thread
+ * fills one while the other holds the samples of the previous snapshot
+ * period. */
+typedef struct ec_timing
+{
+   /** set of histograms filled by the cyclic thread, 0 or 1 */
+   volatile uint32 active;
+   /** set by a snapshot, cleared by the cyclic thread when it switched sets */
+   volatile uint32 request;
+   /** time of the previous send, 0 = none */
+   int64           lastsend;
+   /** round trip time, send to completion of the group */
+   ec_histt        rtt[2];
+   /** period, send to send */
+   ec_histt        period[2];
+   /** duration of the receive call */
+   ec_histt        receive[2];
+} ec_timingt;
+
+/** Summary of the process data timing of a group */
+typedef struct
+{
+   /** round trip time, send to completion of the group */
+   ec_histsnapt    rtt;
+   /** period, send to send */
+   ec_histsnapt    period;
+   /** duration of the receive call */
+   ec_histsnapt    receive;
+} ec_timingsnapt;
+
+#ifdef EC_VER1
+int ec_timing_attach(uint8 group, ec_timingt *timing);
+void ec_timing_detach(uint8 group);
+int ec_timing_snapshot(uint8 group, ec_timingsnapt *snap, int timeout);
+#endif
+
+int ecx_timing_attach(ecx_contextt *context, uint8 group, ec_timingt *timing);
+void ecx_timing_detach(ecx_contextt *context, uint8 group);
+int ecx_timing_snapshot(ecx_contextt *context, uint8 group, ec_timingsnapt *snap, int timeout);
+int64 ecx_timing_send(ecx_contextt *context, const uint8 *groups, int ngroups);
+int64 ecx_timing_start(ecx_contextt *context, const uint8 *groups, int ngroups);
+void ecx_timing_receive(ecx_contextt *context, const uint8 *groups, int ngroups, int64 start);
+void ecx_timing_complete(ec_timingt *timing, int64 sendtime);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _EC_ECATTIMING_H */
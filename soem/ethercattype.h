@@ -73,6 +73,10 @@ extern "C"
 #define EC_NOFRAME         -1
 /** return value unknown frame received */
 #define EC_OTHERFRAME      -2
+/** return value too many slaves */
+#define EC_SLAVECOUNTEXCEEDED -4
+/** return value request not completed yet */
+#define EC_BUSY            -5
 /** maximum EtherCAT frame length in bytes */
 #define EC_MAXECATFRAME    1518
 /** maximum EtherCAT LRW frame length in bytes */
@@ -413,6 +417,7 @@ enum
 enum 
 {
    ECT_REG_TYPE        = 0x0000,
+   ECT_REG_FMMUCNT     = 0x0004,
    ECT_REG_PORTDES     = 0x0007,
    ECT_REG_ESCSUP      = 0x0008,
    ECT_REG_STADR       = 0x0010,
@@ -519,6 +524,50 @@ typedef struct
    };
 } ec_errort;
 
+/** number of bins in a timing histogram, last bin collects all overflows */
+#define EC_HISTBINS        128
+/** bin width selecting a log scale histogram, see ec_hist_init() */
+#define EC_HISTLOG         0
+
+/** Timing histogram, values in ns. The bins have a fixed width or, with
+ * EC_HISTLOG, 4 bins per power of two covering 0 to 8.6s with at most
+ * 25% relative bin width. */
+typedef struct
+{
+   /** width of one bin in ns, EC_HISTLOG for log scale */
+   int32       binwidth;
+   /** number of samples per bin */
+   uint32      bin[EC_HISTBINS];
+   /** total number of samples */
+   uint32      count;
+   /** smallest sample */
+   int64       min;
+   /** largest sample */
+   int64       max;
+   /** sum of all samples, for mean value */
+   int64       sum;
+} ec_histt;
+
+/** Summary of a timing histogram, see ec_hist_snapshot(). Percentiles are
+ * the upper bound of the bin they fall in, limited to the largest sample. */
+typedef struct
+{
+   /** number of samples */
+   uint32      count;
+   /** smallest sample */
+   int64       min;
+   /** mean value */
+   int64       mean;
+   /** median */
+   int64       p50;
+   /** 99th percentile */
+   int64       p99;
+   /** 99.9th percentile */
+   int64       p999;
+   /** largest sample */
+   int64       max;
+} ec_histsnapt;
+
 /** Helper macros */
 /** Macro to make a word from 2 bytes */
 #define MK_WORD(msb, lsb)   ((((uint16)(msb))<<8) | (lsb))
@@ -347,8 +347,6 @@ int main(int argc, char *argv[])
 {
    int iret1;
    int ctime;
-   struct sched_param    param;
-   int                   policy = SCHED_OTHER;
    
    printf("SOEM (Simple Open EtherCAT Master)\nE/BOX test\n");
    
@@ -371,11 +369,12 @@ int main(int argc, char *argv[])
       else
          ctime = 1000; // 1ms cycle time
       /* create RT thread */
-      iret1 = pthread_create( &thread1, NULL, (void *) &ecatthread, (void*) &ctime);   
-      memset(&param, 0, sizeof(param));
-      /* give it higher priority */
-      param.sched_priority = 40;
-      iret1 = pthread_setschedparam(thread1, policy, &param);
+      iret1 = osal_thread_create_rt(&thread1, 128000, &ecatthread, (void*) &ctime, 40, 0);
+      if (!iret1)
+      {
+         printf("Can not create RT thread, running without RT priority.\n");
+         iret1 = osal_thread_create(&thread1, 128000, &ecatthread, (void*) &ctime);
+      }
 
       /* start acyclic part */
       eboxtest(argv[1]);
@@ -0,0 +1,112 @@
+/** \file
+ * \brief Cycle cost benchmark of the process data send path
+ *
+ * Usage : pdbench ifname [cycles]
+ * ifname is NIC interface, f.e. eth0
+ * cycles is number of cycles per test, default 10000
+ *
+ * A synthetic group of 1344 bytes is split in 1, 8 and 64 IO segments and
+ * cycled with and without frame plan. No slave configuration is needed,
+ * the logical range is not mapped by any slave, so the work counter is 0
+ * on a real segment.
+ * Per test the mean and max time of the send call and of the complete
+ * send/receive cycle is printed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ethercattype.h"
+#include "nicdrv.h"
+#include "ethercatbase.h"
+#include "ethercatmain.h"
+
+#define IOSIZE       1344
+#define LOGSTART     0x00010000
+
+uint8 IOmap[IOSIZE];
+int cycles = 10000;
+
+void setupgroup(int nsegments)
+{
+   ec_groupt *grp = &ec_group[0];
+   int i;
+
+   memset(grp, 0, sizeof(*grp));
+   grp->logstartaddr = LOGSTART;
+   grp->Obytes = IOSIZE / 2;
+   grp->Ibytes = IOSIZE / 2;
+   grp->outputs = IOmap;
+   grp->inputs = IOmap + grp->Obytes;
+   grp->nsegments = nsegments;
+   for (i = 0; i < nsegments; i++)
+   {
+      grp->IOsegment[i] = IOSIZE / nsegments;
+   }
+}
+
+void runtest(int nsegments, boolean plan)
+{
+   int64 t0, t1, t2, send, sendmax, cycle, cyclemax;
+   int i, wkc = 0;
+
+   setupgroup(nsegments);
+   if (plan)
+   {
+      ec_frameplan_build(0);
+   }
+   send = sendmax = cycle = cyclemax = 0;
+   for (i = 0; i < cycles; i++)
+   {
+      t0 = osal_current_time_ns();
+      ec_send_processdata();
+      t1 = osal_current_time_ns();
+      wkc = ec_receive_processdata(EC_TIMEOUTRET);
+      t2 = osal_current_time_ns();
+      send += t1 - t0;
+      cycle += t2 - t0;
+      if ((t1 - t0) > sendmax)
+      {
+         sendmax = t1 - t0;
+      }
+      if ((t2 - t0) > cyclemax)
+      {
+         cyclemax = t2 - t0;
+      }
+   }
+   printf("%2d segments %-7s : send %6.0f ns max %7lld ns, cycle %8.0f ns max %8lld ns, "
+      "%d datagrams, wkc %d\n", nsegments, plan ? "plan" : "dynamic",
+      (double)send / cycles, (long long)sendmax, (double)cycle / cycles, (long long)cyclemax,
+      plan ? ec_group[0].nplan : nsegments, wkc);
+}
+
+int main(int argc, char *argv[])
+{
+   int nseg[3] = {1, 8, 64};
+   int i;
+
+   printf("SOEM (Simple Open EtherCAT Master)\nProcess data benchmark\n");
+
+   if (argc < 2)
+   {
+      printf("Usage: pdbench ifname [cycles]\nifname = eth0 for example\n");
+      return 1;
+   }
+   if (argc > 2)
+   {
+      cycles = atoi(argv[2]);
+   }
+   if (!ec_init(argv[1]))
+   {
+      printf("No socket connection on %s\nExcecute as root\n", argv[1]);
+      return 1;
+   }
+   for (i = 0; i < 3; i++)
+   {
+      runtest(nseg[i], FALSE);
+      runtest(nseg[i], TRUE);
+   }
+   ec_close();
+   return 0;
+}
@@ -28,9 +28,9 @@
 #include "ethercatcoe.h"
 #include "ethercatconfig.h"
 #include "ethercatdc.h"
+#include "ethercatcyclic.h"
 #include "ethercatprint.h"
 
-#define NSEC_PER_SEC 1000000000
 #define EC_TIMEOUTMON 500
 
 struct sched_param schedp;
@@ -39,13 +39,11 @@ pthread_t thread1, thread2;
 struct timeval tv, t1, t2;
 int dorun = 0;
 int deltat, tmax = 0;
-int64 toff, gl_delta;
+ec_cyclict cyclic;
 int DCdiff;
 int os;
 uint8 ob;
 uint16 ob2;
-pthread_cond_t      cond  = PTHREAD_COND_INITIALIZER;
-pthread_mutex_t     mutex = PTHREAD_MUTEX_INITIALIZER;
 uint8 *digout = 0;
 int expectedWKC;
 boolean needlf;
@@ -54,9 +52,19 @@ boolean inOP;
 uint8 currentgroup = 0;
 
 
-void redtest(char *ifname, char *ifname2)
+/* application part of the RT cycle, called between receive and send */
+int ecathook(ec_cyclict *cyc, int cwkc, void *arg)
 {
-   int cnt, i, j, oloop, iloop;
+   wkc = cwkc;
+   dorun++;
+   /* if we have some digital output, cycle */
+   if( digout ) *digout = (uint8) ((dorun / 16) & 0xff); 
+   return 1;
+}
+
+void redtest(char *ifname, char *ifname2, int ctime)
+{
+   int cnt, i, j, oloop, iloop, threadok;
    
    printf("Starting Redundant test\n");
    
@@ -98,15 +106,31 @@ void redtest(char *ifname, char *ifname2)
          ec_writestate(0);
          /* activate cyclic process data */
          dorun = 1;
-         /* wait for all slaves to reach OP state */
-         ec_statecheck(0, EC_STATE_OPERATIONAL,  EC_TIMEOUTSTATE);
+         ec_cyclic_init(&cyclic, 0, (int64)ctime * 1000);
+         cyclic.hook = ecathook;
+         /* create RT thread */
+         threadok = osal_thread_create_rt(&thread1, 128000, &ecx_cyclic_run, &cyclic, 40, 0);
+         if (!threadok)
+         {
+            printf("Can not create RT thread, running without RT priority.\n");
+            threadok = osal_thread_create(&thread1, 128000, &ecx_cyclic_run, &cyclic);
+         }
+         if (threadok)
+         {
+            /* wait for all slaves to reach OP state */
+            ec_statecheck(0, EC_STATE_OPERATIONAL,  EC_TIMEOUTSTATE);
+         }
+         else
+         {
+            printf("Can not create thread, no process data.\n");
+         }
          oloop = ec_slave[0].Obytes;
          if ((oloop == 0) && (ec_slave[0].Obits > 0)) oloop = 1;
          if (oloop > 8) oloop = 8;
          iloop = ec_slave[0].Ibytes;
          if ((iloop == 0) && (ec_slave[0].Ibits > 0)) iloop = 1;
          if (iloop > 8) iloop = 8;
-         if (ec_slave[0].state == EC_STATE_OPERATIONAL )
+         if (threadok && (ec_slave[0].state == EC_STATE_OPERATIONAL))
          {
             printf("Operational state reached for all slaves.\n");
             inOP = TRUE;
@@ -114,7 +138,7 @@ void redtest(char *ifname, char *ifname2)
             for(i = 1; i <= 5000; i++)
             {
                printf("Processdata cycle %5d , Wck %3d, DCtime %12lld, dt %12lld, O:",
-                  dorun, wkc , ec_DCtime, gl_delta);
+                  dorun, wkc , ec_DCtime, cyclic.delta);
                for(j = 0 ; j < oloop; j++)
                {
                   printf(" %2.2x", *(ec_slave[0].outputs + j));
@@ -148,6 +172,14 @@ void redtest(char *ifname, char *ifname2)
          ec_slave[0].state = EC_STATE_SAFE_OP;
          /* request SAFE_OP state for all slaves */
          ec_writestate(0);
+         if (threadok)
+         {
+            ecx_cyclic_stop(&cyclic);
+            pthread_join(thread1, NULL);
+            printf("\nCycles %u, overruns %u, max wakeup latency %lld ns, mean %lld ns\n",
+               cyclic.cycles, cyclic.overruns, (long long)cyclic.maxlate,
+               (long long)(cyclic.latency.count ? cyclic.latency.sum / cyclic.latency.count : 0));
+         }
       }
       else
       {
@@ -163,78 +195,6 @@ void redtest(char *ifname, char *ifname2)
    }   
 }   
 
-/* add ns to timespec */
-void add_timespec(struct timespec *ts, int64 addtime)
-{
-   int64 sec, nsec;
-   
-   nsec = addtime % NSEC_PER_SEC;
-   sec = (addtime - nsec) / NSEC_PER_SEC;
-   ts->tv_sec += sec;
-   ts->tv_nsec += nsec;
-   if ( ts->tv_nsec > NSEC_PER_SEC ) 
-   { 
-      nsec = ts->tv_nsec % NSEC_PER_SEC;
-      ts->tv_sec += (ts->tv_nsec - nsec) / NSEC_PER_SEC;
-      ts->tv_nsec = nsec;
-   }   
-}   
-
-/* PI calculation to get linux time synced to DC time */
-void ec_sync(int64 reftime, int64 cycletime , int64 *offsettime)
-{
-   static int64 integral = 0;
-   int64 delta;
-   /* set linux sync point 50us later than DC sync, just as example */
-   delta = (reftime - 50000) % cycletime;
-   if(delta> (cycletime / 2)) { delta= delta - cycletime; }
-   if(delta>0){ integral++; }
-   if(delta<0){ integral--; }
-   *offsettime = -(delta / 100) - (integral / 20);
-   gl_delta = delta;
-}   
-
-/* RT EtherCAT thread */
-void ecatthread( void *ptr )
-{
-   struct timespec   ts, tleft;
-   struct timeval    tp;
-   int rc;
-   int ht;
-   int64 cycletime;
-   
-   rc = pthread_mutex_lock(&mutex);
-   rc = clock_gettime(CLOCK_MONOTONIC, &ts);
-   ht = (ts.tv_nsec / 1000000) + 1; /* round to nearest ms */
-   ts.tv_nsec = ht * 1000000;
-   cycletime = *(int*)ptr * 1000; /* cycletime in ns */
-   toff = 0;
-   dorun = 0;
-   ec_send_processdata();    
-   while(1)
-   {   
-      /* calculate next cycle start */
-      add_timespec(&ts, cycletime + toff);
-      /* wait to cycle start */
-      rc = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, &tleft);
-      if (dorun>0)
-      {
-         wkc = ec_receive_processdata(EC_TIMEOUTRET);
-         
-         dorun++;
-         /* if we have some digital output, cycle */
-         if( digout ) *digout = (uint8) ((dorun / 16) & 0xff); 
-         
-         if (ec_slave[0].hasdc)
-         {   
-            /* calulate toff to get linux time and DC synced */
-            ec_sync(ec_DCtime, cycletime, &toff);
-         }   
-         ec_send_processdata();    
-      }   
-   }    
-}
-
 void ecatcheck( void *ptr )
 {
     int slave;
@@ -313,10 +273,8 @@ void ecatcheck( void *ptr )
 
 int main(int argc, char *argv[])
 {
-   int iret1, iret2;
+   int iret2;
    int ctime;
-   struct sched_param    param;
-   int                   policy = SCHED_OTHER;
    
    printf("SOEM (Simple Open EtherCAT Master)\nRedundancy test\n");
    
@@ -330,18 +288,11 @@ int main(int argc, char *argv[])
       dorun = 0;
       ctime = atoi(argv[3]);
 
-      /* create RT thread */
-      iret1 = pthread_create( &thread1, NULL, (void *) &ecatthread, (void*) &ctime);   
-      memset(&param, 0, sizeof(param));
-      /* give it higher priority */
-      param.sched_priority = 40;
-      iret1 = pthread_setschedparam(thread1, policy, &param);
-
       /* create thread to handle slave error handling in OP */
-      iret2 = pthread_create( &thread2, NULL, (void *) &ecatcheck, (void*) &ctime);   
+      iret2 = osal_thread_create(&thread2, 128000, &ecatcheck, (void*) &ctime);
 
       /* start acyclic part */
-      redtest(argv[1],argv[2]);
+      redtest(argv[1],argv[2],ctime);
    }
    else
    {
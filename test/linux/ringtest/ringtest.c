@@ -0,0 +1,145 @@
+/** \file
+ * \brief Stress test and benchmark for the osal lock-free rings
+ *
+ * Usage : ringtest [count]
+ * count is number of elements per producer, default 10000000
+ *
+ * The SPSC test runs one producer and one consumer thread, the MPSC test
+ * runs several producers into one consumer. The consumer checks that no
+ * element is lost, duplicated or reordered per producer. After each test
+ * the throughput in elements per second is printed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "osal.h"
+
+#define SLOTS        1024
+#define PRODUCERS    4
+
+typedef struct
+{
+   uint32 producer;
+   uint32 seq;
+   uint32 check;
+} elemt;
+
+osal_ringt ring;
+uint8 ringbuf[OSAL_MPSC_BUFSIZE(SLOTS, sizeof(elemt))];
+uint32 count = 10000000;
+volatile int go;
+int errors;
+
+void producer(void *arg)
+{
+   uint32 id = (uint32)(size_t)arg;
+   boolean mpsc = (id > 0);
+   elemt e;
+   uint32 i;
+
+   while (!go)
+   {
+      sched_yield();
+   }
+   e.producer = id;
+   for (i = 0; i < count; i++)
+   {
+      e.seq = i;
+      e.check = ~(i ^ id);
+      /* give up the CPU while full, the test may run on a single core */
+      while (!(mpsc ? osal_mpsc_push(&ring, &e) : osal_spsc_push(&ring, &e)))
+      {
+         sched_yield();
+      }
+   }
+}
+
+void consume(int producers, boolean mpsc)
+{
+   uint32 next[PRODUCERS + 1];
+   uint32 total, received = 0;
+   elemt e;
+
+   memset(next, 0, sizeof(next));
+   total = count * producers;
+   while (received < total)
+   {
+      if (!(mpsc ? osal_mpsc_pop(&ring, &e) : osal_spsc_pop(&ring, &e)))
+      {
+         sched_yield();
+         continue;
+      }
+      received++;
+      if ((e.producer > PRODUCERS) || (e.check != ~(e.seq ^ e.producer)) ||
+          (e.seq != next[e.producer]))
+      {
+         if (errors++ < 10)
+         {
+            printf("ERROR : producer %u seq %u expected %u\n",
+               e.producer, e.seq, next[e.producer]);
+         }
+      }
+      next[e.producer] = e.seq + 1;
+   }
+   if (osal_ring_count(&ring))
+   {
+      printf("ERROR : ring not empty after test\n");
+      errors++;
+   }
+}
+
+void runtest(const char *name, int producers, boolean mpsc)
+{
+   pthread_t thread[PRODUCERS];
+   int64 start, end;
+   int i;
+
+   if (mpsc)
+   {
+      osal_mpsc_init(&ring, ringbuf, SLOTS, sizeof(elemt));
+   }
+   else
+   {
+      osal_spsc_init(&ring, ringbuf, SLOTS, sizeof(elemt));
+   }
+   go = 0;
+   for (i = 0; i < producers; i++)
+   {
+      osal_thread_create(&thread[i], 128000, &producer,
+         (void *)(size_t)(mpsc ? i + 1 : 0));
+   }
+   start = osal_current_time_ns();
+   go = 1;
+   consume(producers, mpsc);
+   end = osal_current_time_ns();
+   for (i = 0; i < producers; i++)
+   {
+      pthread_join(thread[i], NULL);
+   }
+   printf("%s : %d producer(s), %u elements, %.1f Melem/s\n", name, producers,
+      count * producers, (double)count * producers * 1000.0 / (double)(end - start));
+}
+
+int main(int argc, char *argv[])
+{
+   printf("SOEM (Simple Open EtherCAT Master)\nRing test\n");
+
+   if (argc > 1)
+   {
+      count = atoi(argv[1]);
+   }
+   runtest("SPSC", 1, FALSE);
+   runtest("MPSC", 1, TRUE);
+   runtest("MPSC", PRODUCERS, TRUE);
+   if (errors)
+   {
+      printf("FAILED, %d errors\n", errors);
+      return 1;
+   }
+   printf("OK\n");
+   return 0;
+}
@@ -0,0 +1,150 @@
+/** \file
+ * \brief IO segmentation comparison of greedy and balanced segments
+ *
+ * Usage : segtest [configs] [seed]
+ * configs is number of random configurations per size, default 5
+ * seed is the seed of the random configurations, default 1
+ *
+ * Random slave configurations of 100 up to 1000 slaves are segmented with
+ * the greedy and the balanced segmentation, see ecx_config_segment(). No
+ * network is needed, the logical sizes of the slaves are set directly.
+ * Per configuration the number of segments and frames, the smallest and
+ * largest segment and the wire bytes per cycle are printed, with LRW and
+ * with LRD/LWR (blockLRW).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ethercattype.h"
+#include "nicdrv.h"
+#include "ethercatbase.h"
+#include "ethercatmain.h"
+#include "ethercatconfig.h"
+
+#define MAXSLAVES    1000
+
+uint8 IOmap[2 * MAXSLAVES * 64];
+int configs = 5;
+
+/** logical size of a random slave, mostly small terminals and some drives */
+uint32 randomsize(void)
+{
+   int r = rand() % 100;
+
+   if (r < 30)
+   {
+      return 0;
+   }
+   if (r < 60)
+   {
+      return 1 + (rand() % 2);
+   }
+   if (r < 85)
+   {
+      return 4 + (rand() % 8);
+   }
+   if (r < 98)
+   {
+      return 16 + (rand() % 24);
+   }
+   return 64 + (rand() % 128);
+}
+
+void setupconfig(ecx_contextt *context, int nslaves)
+{
+   ec_groupt *grp = &context->grouplist[0];
+   ec_slavet *sl;
+   uint32 obytes = 0, ibytes = 0;
+   int slave;
+
+   *(context->slavecount) = nslaves;
+   for (slave = 1; slave <= nslaves; slave++)
+   {
+      sl = &context->slavelist[slave];
+      memset(sl, 0, sizeof(*sl));
+      sl->Ologsize = randomsize();
+      sl->Ilogsize = randomsize();
+      sl->Obits = (uint16)(sl->Ologsize * 8);
+      sl->Ibits = (uint16)(sl->Ilogsize * 8);
+      obytes += sl->Ologsize;
+      ibytes += sl->Ilogsize;
+   }
+   memset(grp, 0, sizeof(*grp));
+   grp->Obytes = obytes;
+   grp->Ibytes = ibytes;
+   grp->outputs = IOmap;
+   grp->inputs = IOmap + obytes;
+}
+
+void runtest(ecx_contextt *context, boolean balance, boolean blockLRW)
+{
+   ec_groupt *grp = &context->grouplist[0];
+   uint32 smallest, largest;
+   int i, nframes, bytes;
+
+   grp->blockLRW = blockLRW;
+   ecx_config_segment(context, 0, balance);
+   ecx_frameplan_build(context, 0);
+   bytes = ecx_frameplan_wirebytes(context, 0, &nframes);
+   smallest = largest = grp->IOsegment[0];
+   for (i = 1; i < grp->nsegments; i++)
+   {
+      if (grp->IOsegment[i] < smallest)
+      {
+         smallest = grp->IOsegment[i];
+      }
+      if (grp->IOsegment[i] > largest)
+      {
+         largest = grp->IOsegment[i];
+      }
+   }
+   printf("  %-8s %-7s : %2d segments, %3d frames, segment %4u..%4u bytes, "
+      "input start %2d/%4d, %6d wire bytes\n", balance ? "balanced" : "greedy",
+      blockLRW ? "LRD/LWR" : "LRW", grp->nsegments, nframes, smallest, largest,
+      grp->Isegment, grp->Ioffset, bytes);
+}
+
+int main(int argc, char *argv[])
+{
+   ecx_contextparamt params;
+   ecx_contextt *context;
+   int sizes[4] = {100, 250, 500, 1000};
+   int i, j, seed = 1;
+
+   printf("SOEM (Simple Open EtherCAT Master)\nIO segmentation test\n");
+
+   if (argc > 1)
+   {
+      configs = atoi(argv[1]);
+   }
+   if (argc > 2)
+   {
+      seed = atoi(argv[2]);
+   }
+   srand(seed);
+   memset(&params, 0, sizeof(params));
+   params.maxslave = MAXSLAVES + 1;
+   context = ecx_context_create(&params);
+   if (!context)
+   {
+      printf("No memory for context\n");
+      return 1;
+   }
+   for (i = 0; i < 4; i++)
+   {
+      for (j = 0; j < configs; j++)
+      {
+         setupconfig(context, sizes[i]);
+         printf("%4d slaves, %5u output and %5u input bytes\n", sizes[i],
+            context->grouplist[0].Obytes, context->grouplist[0].Ibytes);
+         runtest(context, FALSE, FALSE);
+         runtest(context, TRUE, FALSE);
+         runtest(context, FALSE, TRUE);
+         runtest(context, TRUE, TRUE);
+      }
+   }
+   ecx_context_destroy(context);
+   return 0;
+}
@@ -238,7 +238,7 @@ int main(int argc, char *argv[])
    if (argc > 1)
    {      
       /* create thread to handle slave error handling in OP */
-      iret1 = pthread_create( &thread1, NULL, (void *) &ecatcheck, (void*) &ctime);   
+      iret1 = osal_thread_create(&thread1, 128000, &ecatcheck, (void*) &ctime);
       /* start cyclic part */
       simpletest(argv[1]);
    }